@@ -8,6 +8,12 @@
 #include "ZMaps/MapLoader.h"
 #include "ZPixels/ImagePixelRepo.h"
 #include "ZMovement/MovementUtil.h"
+#include "ZMovement/FlowField.h"
+#include "ZMovement/PathService.h"
+#include "ZMaps/VisibilityMap.h"
+#include "ZUtility/Metrics.h"
+#include "ZUtility/ScriptedInput.h"
+#include "ZUtility/Random.h"
 #include "ZObjects/ZombieFactory.h"
 #include "ZObjects/StaticObjectFactory.h"
 #include <memory>
@@ -33,16 +39,20 @@ ZEngine::~ZEngine() {
     m_bloodCoordinates.clear();
     m_livingCoordinates.clear();
     m_keyTiles.clear();
+    m_pathService.reset(); //Stops the worker threads
     m_aStar.reset();
-    m_mapFilter.reset();
+    m_flowField.reset();
+    m_visibilityMap.reset();
     ImagePixelRepo::deleteRepo();
+    Metrics::close(); //Finish writing the profiling CSV
 }
 
 
 int ZEngine::virtInitialise() {
 
     //initialise our image/pixel repo
-    ImagePixelRepo::initialise();
+    ImagePixelRepo::initialise(m_tileSize);
+    m_dirtyRegions.resize(getWindowWidth(), getWindowHeight());
 
     //Initialise the starting state (Menu)
     m_currentState = make_shared<StateMenu>(this);
@@ -60,6 +70,8 @@ int ZEngine::virtInitialise() {
 void ZEngine::startLevel(string levelNumber, bool fromSave){
 
     pause();
+    //New level so new random numbers (a loaded save already has its own)
+    if (!fromSave) Random::seedLevel(levelNumber);
     //Either create a new level runner or tell the old one to re-initialse
     if (!m_currentLevel)
         m_currentLevel = make_shared<LevelRunner>(this, levelNumber, fromSave);
@@ -68,23 +80,85 @@ void ZEngine::startLevel(string levelNumber, bool fromSave){
 
     //Need to update current state since objects depend on this to initialse themselves
     m_currentState = m_currentLevel;
+    m_dirtyRegions.invalidateAll(); //Whole new map to show
     virtInitialiseObjects(); //Initialise our objects based on this level
     
     m_currentLevelNumber.clear();
     m_currentLevelNumber = levelNumber; //Update our level Number/Name for use with saving
     //Show our objects
     setAllObjectsVisible(true);
-    SaveLoadUtil::saveGame(this, 0, "AutoSave"); //Create an autosave file for the new level
+    //Create an autosave file for the new level (not from a headless run, don't want to overwrite the player's)
+    if (!isHeadless()) SaveLoadUtil::saveGame(this, 0, "AutoSave");
     unpause(); //Never actually paused it...
 }
 
-void ZEngine::setAStar(MapTileManager* newMap) { 
+void ZEngine::setAStar(MapTileManager* newMap, const vector<KeyTile>& changedTiles) { 
+    m_pathMap = newMap;
+
+    //Only the path finding in use is kept up to date, the others would be out of date so are thrown away
+    //(made again from scratch if they're selected later)
+    if (m_pathMode != p_aStar && m_pathMode != p_jumpPoint) m_aStar.reset();
+    if (m_pathMode != p_flowField) m_flowField.reset();
+    if (m_pathMode != p_pathService) m_pathService.reset(); //Stops its worker threads
+
+    //If just updating, then just re-set values to use the new tileManager (repaired around the changed tiles)
+    if (m_aStar) m_aStar->resetMap(newMap, changedTiles);
+    if (m_flowField) m_flowField->resetMap(newMap, changedTiles);
+    if (m_pathService) m_pathService->setGrid(std::make_shared<const CollisionGrid>(this, newMap));
+    //Otherwise create it
+    createPathFinding();
+
+    //Line of sight may have changed too
+    if(!m_visibilityMap) m_visibilityMap = std::make_shared<VisibilityMap>(newMap, getTilesX(), getTilesY(), getTileSize());
+    else m_visibilityMap->resetMap(newMap);
+}
+
+void ZEngine::setPathMode(PathMode mode) {
+    m_pathMode = mode;
+    if (m_pathMap) createPathFinding();
+}
+
+//Creates the path finding for the current mode unless it already exists
+void ZEngine::createPathFinding() {
+    switch (m_pathMode) {
+        case p_pathService:
+            if (m_pathService) return;
+            m_pathService = std::make_shared<PathService>();
+            //Works from its own copy of the map so its threads never touch the real one
+            m_pathService->setGrid(std::make_shared<const CollisionGrid>(this, m_pathMap));
+            return;
+        case p_flowField:
+            //Calculated on the next update
+            if (!m_flowField) m_flowField = std::make_shared<FlowField>(this, m_pathMap);
+            return;
+        case p_aStar:
+        case p_jumpPoint:
+            if (!m_aStar) m_aStar = std::make_shared<AStar>(this, m_pathMap);
+            return;
+    }
+}
+
+void ZEngine::updatePathFinding() {
+    //Only the one enemies are using
+    if (m_pathMode == p_flowField && m_flowField) m_flowField->update(playerX, playerY);
+    if (m_pathMode == p_pathService && m_pathService) m_pathService->update(playerX, playerY);
+}
 
-    //Create our AStar unless it already exists
-    if(!m_aStar ) m_aStar = std::make_shared<AStar>(this, newMap);
+SpatialGrid<ZEnemy>::Box ZEngine::getCollisionBox(const LivingObject* object) const {
+    //Virtual location through the level's map filter works for both the player (fixed on screen) and enemies
+    //(on the map), the player doesn't have a filter of its own so can't just use its real location
+    MapOffsetFilter* mapFilter = getMapFilter().get();
+    int left = mapFilter->filterConvertVirtualToRealXPosition(object->getVirtX());
+    int top = mapFilter->filterConvertVirtualToRealYPosition(object->getVirtY());
+    return {left, top, left + object->getDrawWidth(), top + object->getDrawHeight()};
+}
+
+void ZEngine::updateEnemyGrid(ZEnemy* enemy) {
+    m_enemyGrid.update(enemy, getCollisionBox(enemy));
+}
 
-    //If just updating, then just re-set values to use the new tileManager
-    else m_aStar->resetMap(newMap);
+void ZEngine::updateVisibility() {
+    if (m_visibilityMap) m_visibilityMap->update(playerX, playerY);
 }
 
 //Called by the various levels and after loading
@@ -92,6 +166,8 @@ int ZEngine::virtInitialiseObjects() {
 
     drawableObjectsChanged();
     destroyOldObjects(true);
+    //Enemies add themselves as they're created, cells are two tiles across
+    m_enemyGrid.resize(getTilesX() * getTileSize(), getTilesY() * getTileSize(), getTileSize() * 2);
 
     //Create our array based on how many objects are in this level
     createObjectArray(static_cast<int>(m_livingCoordinates.size()));
@@ -138,6 +214,8 @@ void ZEngine::setState(State newState){
         //Show our objects
         setAllObjectsVisible(true);
         unpause();
+        //Screen still has the last state's drawing on it
+        m_dirtyRegions.invalidateAll();
     } else {
         //Otherwise we always pause then set a different state
         setAllObjectsVisible(false);
@@ -166,6 +244,7 @@ void ZEngine::setState(State newState){
         default:
             break;
     }
+    if (m_headless) return; //Nothing is ever drawn
     //Re-set up background
     lockAndSetupBackground();
     //Force a re-draw
@@ -233,16 +312,65 @@ bool ZEngine::updatePlayerMovement(){
     return playerMovement->updateMovement(playerX, playerY);
 }
 
-shared_ptr<MapTileManager> ZEngine::getCollisionMap() const {
-    return m_currentLevel->getCollisionMap();
+int ZEngine::getGameTime() {
+    return m_headless ? m_headlessTime : getModifiedTime();
+}
+
+int ZEngine::getGameMouseX() {
+    return m_headless ? m_scriptedInput->getMouseX() : getCurrentMouseX();
+}
+
+int ZEngine::getGameMouseY() {
+    return m_headless ? m_scriptedInput->getMouseY() : getCurrentMouseY();
+}
+
+int ZEngine::runHeadless(const HeadlessSettings& settings) {
+
+    m_headless = true;
+    m_headlessTime = 0;
+    //Same seed means the same enemy skins, drops, blood etc. every run
+    Random::setBaseSeed(settings.seed);
+    m_scriptedInput = make_shared<ScriptedInput>();
+    if (!settings.inputScript.empty() && !m_scriptedInput->load(settings.inputScript)) return 1;
+
+    //Straight into the level, no menu
+    m_bloodCoordinates.clear();
+    startLevel(settings.levelNumber);
+
+    int frame = 0;
+    while (frame < settings.frames && m_scriptedInput->apply(this, frame)) {
+        m_headlessTime += settings.timeStep;
+        //Same order as the main loop, just without drawing anything
+        virtMainLoopDoBeforeUpdate();
+        //Paths handed to the workers this frame are always picked up next frame, however fast they are
+        if (m_pathService) m_pathService->waitForWorkers();
+        updateAllObjectsHeadless(getGameTime());
+        virtMainLoopPostUpdate();
+        frame++;
+        //Paused, game over or finished the game, nothing left to run
+        if (m_currentState != m_currentLevel) break;
+    }
+
+    cout << "Headless run finished after " << frame << " frames on " << m_currentLevelNumber
+         << (m_currentState == m_currentLevel ? " (still running)" : " (level stopped)") << endl;
+    return 0;
+}
+
+//Objects are only added/removed after updating (virtMainLoopPostUpdate) so the array can't change under us
+void ZEngine::updateAllObjectsHeadless(int currentTime) {
+    for (int i = 0; ; ++i) {
+        DisplayableObject* object = getDisplayableObject(i);
+        if (object == nullptr) break; //Reached the end of the objects
+        object->virtDoUpdate(currentTime);
+    }
 }
 
-DrawingSurface* ZEngine::getEffectsSurface() const {
-    return m_currentLevel->getEffectsSurface();
+shared_ptr<MapTileManager> ZEngine::getCollisionMap() const {
+    return m_currentLevel->getCollisionMap();
 }
 
-DrawingSurface* ZEngine::getSrcSurface() const {
-    return m_currentLevel->getSrcSurface();
+WorldSurface* ZEngine::getWorldSurface() const {
+    return m_currentLevel->getWorldSurface();
 }
 
 shared_ptr<MapOffsetFilter> ZEngine::getMapFilter() const {
@@ -255,14 +383,23 @@ void ZEngine::virtSetupBackgroundBuffer() {
 }
 
 void ZEngine::copyAllBackgroundBuffer() {
+    METRICS_TIME(t_backgroundCopy);
     m_currentState->copyAllBackgroundBuffer();
 }
 void ZEngine::virtPostDraw() {
-    m_currentState->postDraw();
+    {
+        METRICS_TIME(t_postDraw);
+        m_currentState->postDraw();
+    }
+    //Profiling numbers on top of everything (F3)
+    if (Metrics::drawOverlay(getForegroundSurface(), getFont("./resources/Fonts/Branda-yolq.ttf", 18)))
+        m_dirtyRegions.drawnOver(0, 0, Metrics::m_overlayWidth, Metrics::m_overlayHeight);
 }
 
 //Do things first IF we're updating
 void ZEngine::virtMainLoopDoBeforeUpdate() {
+    //New frame for the profiling numbers
+    Metrics::endFrame();
     m_currentState->beforeUpdate();
 }
 
@@ -283,6 +420,10 @@ void ZEngine::virtKeyDown(int iKeyCode) {
     if (iKeyCode == SDL_WINDOWEVENT_CLOSE) {
         setExitWithCode(0);
     }
+    //Profiling overlay works in any state
+    if (iKeyCode == SDLK_F3) {
+        Metrics::toggleOverlay();
+    }
     m_currentState->handleKeyDown(iKeyCode);
     //ALL states need too exit on windows exit
    
@@ -13,6 +13,8 @@
 #include <memory>
 #include <utility>
 #include "./ZUtility/InfoStructs.h"
+#include "./ZUtility/SpatialGrid.h"
+#include "./ZUtility/DirtyRegions.h"
 
 //class ZCharacter;
 //Forward declarations to avoid circular dependency
@@ -20,9 +22,15 @@ class ZPlayer;
 class MovementUtil;
 class LivingObject;
 class GameObject;
+class ZEnemy;
 class AStar;
+class FlowField;
+class PathService;
+class VisibilityMap;
 class iStateHandler;
 class LevelRunner;
+class ScriptedInput;
+class WorldSurface;
 
 using namespace std;
 
@@ -60,6 +68,11 @@ public:
     //Get/Set the keys used in this level so we know when we've got them all
     int getTotalKeys() const { return m_totalKeys;}
     void setTotalKeys(int keys) { m_totalKeys = keys;}
+    //Time (ms) the game should use, a fixed step per frame when headless otherwise the engine's time
+    int getGameTime();
+    //Mouse location the game should use, from the input script when headless
+    int getGameMouseX();
+    int getGameMouseY();
     //Methods completely handled By State
     void virtSetupBackgroundBuffer() override;
     void copyAllBackgroundBuffer() override;
@@ -109,7 +122,30 @@ private:
 public:
     ZPlayer* getPlayer() const {return m_player;}
     AStar* getAStar() const { return m_aStar.get(); }
-    void setAStar(MapTileManager* newMap);
+    //Changed tiles (i.e. doors unlocking) let the path finding only rebuild the areas around them
+    void setAStar(MapTileManager* newMap, const vector<KeyTile>& changedTiles = {});
+    //Shared distance map towards the player, used by enemies instead of their own A* searches
+    FlowField* getFlowField() const { return m_flowField.get(); }
+    //Solves enemy paths on worker threads, results are picked up on a later tick
+    PathService* getPathService() const { return m_pathService.get(); }
+    void updatePathFinding(); //Once per tick, after the player has moved (just the path finding in use)
+    //Which tiles can see the player, shared by everything that needs line of sight to them
+    VisibilityMap* getVisibilityMap() const { return m_visibilityMap.get(); }
+    void updateVisibility(); //Re-calculates if the player has changed tile
+    //Live enemies by the box they're drawn over (real map), kept up to date by the enemies themselves
+    //Used for what the laser hits and who could be touching before checking pixels
+    SpatialGrid<ZEnemy>& getEnemyGrid() { return m_enemyGrid; }
+    //Box an object is currently drawn over (real map), for the player (fixed on screen) or enemies (on the map)
+    SpatialGrid<ZEnemy>::Box getCollisionBox(const LivingObject* object) const;
+    //Puts the enemy's current draw area into the enemy grid
+    void updateEnemyGrid(ZEnemy* enemy);
+    //Parts of the screen that need the background copied back, anything drawn over the map should say where
+    DirtyRegions& getDirtyRegions() { return m_dirtyRegions; }
+    //Which method enemies use to find their way to the player
+    enum PathMode {p_pathService, p_flowField, p_aStar, p_jumpPoint};
+    PathMode getPathMode() const { return m_pathMode; }
+    //Creates the path finding for that mode the first time it's selected
+    void setPathMode(PathMode mode);
     int getTileSize() const { return m_tileSize; }
     int getTilesX() const { return srcTilesX; }
     int getTilesY() const { return srcTilesY; }
@@ -117,16 +153,22 @@ public:
     shared_ptr<MovementUtil> getPlayerMovementUtil() const { return playerMovement ; }
     shared_ptr<MapOffsetFilter> getMapFilter() const;
     shared_ptr<MapTileManager> getCollisionMap() const;
-    DrawingSurface* getEffectsSurface() const;
-    DrawingSurface* getSrcSurface() const;
+    WorldSurface* getWorldSurface() const; //The map as drawn, blood etc is stamped onto it
     //DrawingSurface* getBackgroundSurface() { return m_pBackgroundSurface; }
 
 private:
+    void createPathFinding(); //For the current mode, unless it already exists
     ZPlayer* m_player = nullptr;
     shared_ptr<AStar> m_aStar = nullptr; //Used to create/delete our actual a_Star
+    shared_ptr<FlowField> m_flowField = nullptr;
+    shared_ptr<PathService> m_pathService = nullptr;
+    shared_ptr<VisibilityMap> m_visibilityMap = nullptr;
+    SpatialGrid<ZEnemy> m_enemyGrid;
+    DirtyRegions m_dirtyRegions;
+    PathMode m_pathMode = p_pathService;
+    MapTileManager* m_pathMap = nullptr; //Collision map the path finding was last set up with
     //shared_ptr<AStar> m_pfixedAStar = nullptr; //Held by objects so they can retrieve new aStar
     shared_ptr<MovementUtil> playerMovement = nullptr;
-    shared_ptr<MapOffsetFilter> m_mapFilter = nullptr;
     int srcTilesX = 100;
     int srcTilesY = 100;
     int m_tileSize = 64;
@@ -134,6 +176,26 @@ private:
     int playerX = 0;
     int playerY = 0;
 
+//Headless running (no drawing, fixed time step, input from a file), for soak testing without a display
+public:
+    struct HeadlessSettings {
+        string levelNumber = "LevelOne";
+        string inputScript; //Empty means no input at all
+        int frames = 10000;
+        int timeStep = 20; //ms per frame
+        unsigned int seed = 1; //Base seed for the random streams, so the same settings always play out the same
+    };
+    //Runs the level (instead of the main loop) until the frames run out, the script quits or the level ends
+    //Needs the engine to have been initialised already, returns non 0 if the input script couldn't be loaded
+    int runHeadless(const HeadlessSettings& settings);
+    bool isHeadless() const { return m_headless; }
+
+private:
+    void updateAllObjectsHeadless(int currentTime);
+    bool m_headless = false;
+    int m_headlessTime = 0;
+    shared_ptr<ScriptedInput> m_scriptedInput = nullptr;
+
 
 
 
@@ -0,0 +1,48 @@
+//
+// Created by Chris Greer on 14/05/2024.
+//
+
+//Entry point for the headless build (define G52CPP_HEADLESS and use this instead of the framework's main)
+//Runs a level with no window to draw to, a fixed time step and input from a script, e.g.
+//  ZombieHeadless --level LevelTwo --input ./soak.txt --frames 50000 --step 20 --seed 7
+#ifdef G52CPP_HEADLESS
+
+#include "../header.h"
+#include "ZEngine.h"
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+
+    ZEngine::HeadlessSettings settings;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string option = argv[i];
+        string value = argv[i + 1];
+        if (option == "--level") settings.levelNumber = value;
+        else if (option == "--input") settings.inputScript = value;
+        else if (option == "--frames") settings.frames = atoi(value.c_str());
+        else if (option == "--step") settings.timeStep = max(1, atoi(value.c_str()));
+        else if (option == "--seed") settings.seed = static_cast<unsigned int>(strtoul(value.c_str(), nullptr, 10));
+        else {
+            cerr << "Unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    //SDL still needs a video driver for the surfaces, the dummy one doesn't need a display
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+
+    int result;
+    {
+        ZEngine engine;
+        result = engine.initialise("Zombie Shooter (headless)", BASE_SCREEN_WIDTH, BASE_SCREEN_HEIGHT,
+                                   "./resources/Fonts/Branda-yolq.ttf", 24);
+        if (result == 0) result = engine.runHeadless(settings);
+        engine.deinitialise();
+    }
+    return result;
+}
+
+#endif //G52CPP_HEADLESS
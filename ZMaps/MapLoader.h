@@ -112,6 +112,13 @@ public:
     //Loads map using specific map tile manager reference
     static void loadTileMap(ZEngine *pEngine, DrawingSurface *pSurface, MapTileManager *map, const string &mapPath){
 
+        loadTileValues(pEngine, map, mapPath);
+        map->drawAllTiles(pEngine, pSurface);
+    }
+
+    //Just reads the values into the map, doesn't draw anything (e.g. for a WorldSurface layer, drawn when needed)
+    static void loadTileValues(ZEngine *pEngine, MapTileManager *map, const string &mapPath){
+
         ifstream mapDoc;
         mapDoc.open(mapPath);
         int mapValue;
@@ -127,7 +134,6 @@ public:
                 map->setMapValue(x, y, mapValue);
             }
         }
-        map->drawAllTiles(pEngine, pSurface);
 
         mapDoc.close();
     }
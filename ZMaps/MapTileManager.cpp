@@ -5,6 +5,8 @@
 #include "MapTileManager.h"
 #include "../ZPixels/ImagePixelRepo.h"
 #include "../ZPixels/PixelCollisionUtil.h"
+#include "../ZUtility/TileCodes.h"
+#include "../ZUtility/TileTraversal.h"
 //#include "ZEngine.h"
 
 MapTileManager::MapTileManager(ZEngine* pEngine, int tileWidth, int tileHeight)
@@ -13,6 +15,7 @@ MapTileManager::MapTileManager(ZEngine* pEngine, int tileWidth, int tileHeight)
     //Load our tiles image and pixel map
     m_tilesImage = (*ImagePixelRepo::getSingleImages()).at("Tiles");
     m_pixelMap = (*ImagePixelRepo::getSinglePixelMaps()).at("Tiles");
+    m_distanceField = ImagePixelRepo::getTileDistanceField();
 }
 
 void MapTileManager::virtDrawTileAt(BaseEngine *pEngine, DrawingSurface *pSurface,
@@ -32,23 +35,24 @@ void MapTileManager::virtDrawTileAt(BaseEngine *pEngine, DrawingSurface *pSurfac
 
 
 
-    //Paint some random details
+    //Paint some random details, each tile has its own numbers so it always gets the same details
+    RandomStream random = Random::forKey(Random::r_tileDetail, Random::key(iMapX, iMapY, mapValue));
     vector<shared_ptr<SimpleImage>>* images = (*ImagePixelRepo::getMultiImages()).at("GrassDetails").get();
     if (mapValue == 1){ //For grass, randomly add details
-        paintRandomDetail(images,10,pSurface,iStartPositionScreenX,iStartPositionScreenY);
+        paintRandomDetail(images,10,pSurface,iStartPositionScreenX,iStartPositionScreenY,random);
     }// Any other details?
 
     //Random Blood
     images = (*ImagePixelRepo::getMultiImages()).at("BloodDetails").get();
     if ((mapValue >= 1 && mapValue <= 3) || (mapValue >= 5 && mapValue <= 14) ||
     (mapValue >= 27 && mapValue <= 29) || (mapValue >= 42 && mapValue <= 44))
-        paintRandomDetail(images, 7, pSurface, iStartPositionScreenX, iStartPositionScreenY);
+        paintRandomDetail(images, 7, pSurface, iStartPositionScreenX, iStartPositionScreenY, random);
 
     //Random Cracks
     images = (*ImagePixelRepo::getMultiImages()).at("CracksDetails").get();
     if ((mapValue >= 2 && mapValue <= 3) || (mapValue >= 5 && mapValue <= 14) ||
         (mapValue >= 27 && mapValue <= 29) || (mapValue >= 42 && mapValue <= 44))
-        paintRandomDetail(images, 4, pSurface, iStartPositionScreenX, iStartPositionScreenY);
+        paintRandomDetail(images, 4, pSurface, iStartPositionScreenX, iStartPositionScreenY, random);
 
 
 }
@@ -56,14 +60,15 @@ void MapTileManager::virtDrawTileAt(BaseEngine *pEngine, DrawingSurface *pSurfac
 void MapTileManager::paintRandomDetail(vector<shared_ptr<SimpleImage>>* images, int probability,
                                        DrawingSurface *pSurface,
                                        int xStart,
-                                       int yStart) {
+                                       int yStart,
+                                       RandomStream& random) {
 
-    if(rand() % 100 > probability) return;
+    if(random.nextInt(100) > probability) return;
 
     SimpleImage* detail = nullptr;
     if (!images->empty()){
-        int random = rand() % images->size();
-            detail = (*images)[random].get();
+        int randomImage = random.nextInt(static_cast<int>(images->size()));
+            detail = (*images)[randomImage].get();
     
         //If we'll have details, draw them
         if (detail->getTheData() != nullptr)
@@ -98,6 +103,171 @@ bool MapTileManager::pixelIsAt(int xVal, int yVal, bool realValues) {
     return PixelCollisionUtil::checkPixel(m_pixelMap.get(),imageX,imageY);
 }
 
+float MapTileManager::clearance(int xVal, int yVal, bool pixelPerfect, bool realValues) {
+    if (!realValues){
+        xVal = m_pEngine->getMapFilter()->filterConvertVirtualToRealXPosition(xVal);
+        yVal = m_pEngine->getMapFilter()->filterConvertVirtualToRealYPosition(yVal);
+    }
+    int x = xVal - m_iBaseScreenX;
+    int y = yVal - m_iBaseScreenY;
+    int tileWidth = getTileWidth();
+    int tileHeight = getTileHeight();
+    int centreTileX = x >= 0 ? x / tileWidth : -1;
+    int centreTileY = y >= 0 ? y / tileHeight : -1;
+
+    //Anything further out than the tiles around us is at least this far
+    auto nearest = static_cast<float>(min(tileWidth, tileHeight));
+    for (int tileY = max(0, centreTileY - 1); tileY <= min(m_iMapHeight - 1, centreTileY + 1); ++tileY) {
+        for (int tileX = max(0, centreTileX - 1); tileX <= min(m_iMapWidth - 1, centreTileX + 1); ++tileX) {
+            int mapValue = getMapValue(tileX, tileY);
+            if (!TileCodes::isCollisionTile(mapValue)) continue;
+
+            //Closest pixel of the tile to us, and how far that is
+            int closestX = min(max(x, tileX * tileWidth), (tileX + 1) * tileWidth - 1);
+            int closestY = min(max(y, tileY * tileHeight), (tileY + 1) * tileHeight - 1);
+            auto gap = static_cast<float>(hypot(closestX - x, closestY - y));
+
+            //Can't be any closer than the tile itself, or than that pixel's distance to a solid one less the gap
+            float distance = gap;
+            if (pixelPerfect && m_distanceField) {
+                float fromClosest = m_distanceField->distance(offsetX(mapValue) + closestX - tileX * tileWidth,
+                                                              offsetY(mapValue) + closestY - tileY * tileHeight);
+                distance = max(gap, fromClosest - gap);
+            }
+            nearest = min(nearest, distance);
+        }
+    }
+    return nearest;
+}
+
+bool MapTileManager::fillCollisionMask(PixelMask& mask, int virtualLeft, int virtualTop, bool pixelPerfect) {
+    //Work on the real map from here
+    int left = m_pEngine->getMapFilter()->filterConvertVirtualToRealXPosition(virtualLeft) - m_iBaseScreenX;
+    int top = m_pEngine->getMapFilter()->filterConvertVirtualToRealYPosition(virtualTop) - m_iBaseScreenY;
+    int tileWidth = getTileWidth();
+    int tileHeight = getTileHeight();
+
+    //Just the tiles under the box (rounding down for anything off the top/left)
+    int firstTileX = max(0, left >= 0 ? left / tileWidth : -1);
+    int firstTileY = max(0, top >= 0 ? top / tileHeight : -1);
+    int lastTileX = min(m_iMapWidth - 1, (left + mask.getWidth() - 1) / tileWidth);
+    int lastTileY = min(m_iMapHeight - 1, (top + mask.getHeight() - 1) / tileHeight);
+
+    bool anyCollisionTiles = false;
+    for (int tileY = firstTileY; tileY <= lastTileY; ++tileY) {
+        for (int tileX = firstTileX; tileX <= lastTileX; ++tileX) {
+            int mapValue = getMapValue(tileX, tileY);
+            if (!TileCodes::isCollisionTile(mapValue)) continue;
+            anyCollisionTiles = true;
+
+            //Where the tile is in the box
+            int x = tileX * tileWidth - left;
+            int y = tileY * tileHeight - top;
+            if (pixelPerfect)
+                mask.copyFrom(*m_pixelMap, offsetX(mapValue), offsetY(mapValue), x, y, tileWidth, tileHeight);
+            else
+                mask.fillRect(x, y, tileWidth, tileHeight);
+        }
+    }
+    return anyCollisionTiles;
+}
+
+bool MapTileManager::sweepCollisionTiles(int virtualLeft, int virtualTop, int width, int height, int moveX, int moveY,
+                                         float& contactTime, int& normalX, int& normalY) {
+    int left = m_pEngine->getMapFilter()->filterConvertVirtualToRealXPosition(virtualLeft) - m_iBaseScreenX;
+    int top = m_pEngine->getMapFilter()->filterConvertVirtualToRealYPosition(virtualTop) - m_iBaseScreenY;
+    int right = left + width;
+    int bottom = top + height;
+    int tileWidth = getTileWidth();
+    int tileHeight = getTileHeight();
+
+    //Only the tiles the box passes over on the way
+    int sweptLeft = left + min(moveX, 0);
+    int sweptTop = top + min(moveY, 0);
+    int firstTileX = max(0, sweptLeft >= 0 ? sweptLeft / tileWidth : -1);
+    int firstTileY = max(0, sweptTop >= 0 ? sweptTop / tileHeight : -1);
+    int lastTileX = min(m_iMapWidth - 1, (right + max(moveX, 0) - 1) / tileWidth);
+    int lastTileY = min(m_iMapHeight - 1, (bottom + max(moveY, 0) - 1) / tileHeight);
+
+    bool hit = false;
+    contactTime = 1.0f;
+    normalX = 0;
+    normalY = 0;
+    for (int tileY = firstTileY; tileY <= lastTileY; ++tileY) {
+        for (int tileX = firstTileX; tileX <= lastTileX; ++tileX) {
+            if (!TileCodes::isCollisionTile(getMapValue(tileX, tileY))) continue;
+
+            //When (along the move) the box starts and stops overlapping the tile on each axis
+            float entryX, exitX, entryY, exitY;
+            if (!sweepAxis(left, right, tileX * tileWidth, (tileX + 1) * tileWidth, moveX, entryX, exitX)) continue;
+            if (!sweepAxis(top, bottom, tileY * tileHeight, (tileY + 1) * tileHeight, moveY, entryY, exitY)) continue;
+
+            //Only touching when it's overlapping on both at once
+            float entry = max(entryX, entryY);
+            float exit = min(exitX, exitY);
+            if (entry > exit || entry >= 1.0f || exit <= 0.0f) continue;
+
+            entry = max(entry, 0.0f);
+            if (!hit || entry < contactTime) {
+                contactTime = entry;
+                //Whichever axis started overlapping last is the side we hit
+                normalX = entryX >= entryY ? (moveX > 0 ? -1 : 1) : 0;
+                normalY = entryX >= entryY ? 0 : (moveY > 0 ? -1 : 1);
+            }
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+bool MapTileManager::sweepAxis(int from, int to, int tileFrom, int tileTo, int move, float& entry, float& exit) {
+    if (move == 0) {
+        //Not moving on this axis, it's either overlapping the whole time or never
+        if (from >= tileTo || to <= tileFrom) return false;
+        entry = -INFINITY;
+        exit = INFINITY;
+        return true;
+    }
+    if (move > 0) {
+        entry = static_cast<float>(tileFrom - to) / static_cast<float>(move);
+        exit = static_cast<float>(tileTo - from) / static_cast<float>(move);
+    } else {
+        entry = static_cast<float>(tileTo - from) / static_cast<float>(move);
+        exit = static_cast<float>(tileFrom - to) / static_cast<float>(move);
+    }
+    return true;
+}
+
+bool MapTileManager::lineOfSight(int fromX, int fromY, int toX, int toY) const {
+    //Work in tiles rather than pixels
+    auto tileWidth = static_cast<float>(getTileWidth());
+    auto tileHeight = static_cast<float>(getTileHeight());
+    return TileTraversal::traverse(static_cast<float>(fromX - m_iBaseScreenX) / tileWidth,
+                                   static_cast<float>(fromY - m_iBaseScreenY) / tileHeight,
+                                   static_cast<float>(toX - m_iBaseScreenX) / tileWidth,
+                                   static_cast<float>(toY - m_iBaseScreenY) / tileHeight,
+                                   [this](int tileX, int tileY){ return !blocksLos(tileX, tileY); });
+}
+
+bool MapTileManager::isOpaque(int tileX, int tileY) const {
+    if (tileX < 0 || tileY < 0 || tileX >= m_iMapWidth || tileY >= m_iMapHeight) return false;
+    int mapValue = getMapValue(tileX, tileY);
+    if (mapValue < 0) return false;
+    if (mapValue >= static_cast<int>(m_opaqueValues.size())) m_opaqueValues.resize(mapValue + 1, -1);
+
+    //Only have to look at the pixel map once for each value
+    if (m_opaqueValues[mapValue] < 0) {
+        bool opaque = true;
+        for (int y = 0; y < m_iTileHeight && opaque; ++y) {
+            for (int x = 0; x < m_iTileWidth && opaque; ++x) {
+                opaque = PixelCollisionUtil::checkPixel(m_pixelMap.get(), offsetX(mapValue) + x, offsetY(mapValue) + y);
+            }
+        }
+        m_opaqueValues[mapValue] = opaque ? 1 : 0;
+    }
+    return m_opaqueValues[mapValue] == 1;
+}
+
 //Tells you where (which pixel) in the tile you are (X axis)
 int MapTileManager::getXLocationInTile(int virtualX ) {
     int realX = m_pEngine->getMapFilter()->filterConvertVirtualToRealXPosition(virtualX);
@@ -7,6 +7,9 @@
 
 #include "../../header.h"
 #include "../ZPixels/PixelMapCreator.h"
+#include "../ZPixels/DistanceField.h"
+#include "../ZUtility/Random.h"
+#include "../ZUtility/TileCodes.h"
 #include "../../TileManager.h"
 #include "../../ImagePixelMapping.h"
 #include "../../BaseEngine.h"
@@ -36,20 +39,58 @@ public:
     int offsetY(int mapValue) const { return (mapValue / 10) * m_iTileHeight;}
     //Tells you whether there's filled pixels at that exact location
     bool pixelIsAt(int xVal, int yVal, bool realValues = false);
+    //How far (at least) from this location to the nearest collision, only looks up to a tile away
+    //so anything a tile or more away just gives the tile size
+    //Either the nearest solid pixel of a collision tile (pixelPerfect) or the nearest collision tile at all
+    float clearance(int xVal, int yVal, bool pixelPerfect, bool realValues = false);
+    //Marks which pixels of a box (top left at this virtual location, the size of the mask) are over collision tiles
+    //Either the whole tile or (pixelPerfect) just where the tile is actually drawn
+    //Returns false if there weren't any collision tiles under the box at all
+    bool fillCollisionMask(PixelMask& mask, int virtualLeft, int virtualTop, bool pixelPerfect);
+    //Sweeps a box (virtual location) along a move and finds the first collision tile it would touch (swept AABB)
+    //Gives how far along the move it touches (0 to 1) and which side it hits (normal points back out of the tile)
+    //Returns false if it never touches one
+    bool sweepCollisionTiles(int virtualLeft, int virtualTop, int width, int height, int moveX, int moveY,
+                             float& contactTime, int& normalX, int& normalY);
     //Tells you where (which pixel) in the tile you are (X axis)
     int getXLocationInTile(int virtualX );
     //Tells you where (which pixel) in the tile you are (Y axis)
     int getYLocationInTile(int virtualY );
 
+    //Masks to check collisions against this map in, kept so checks aren't allocating every time
+    //Belong to the map, so anything checking from another thread needs a map (or copy) of its own
+    struct CollisionBuffers {
+        PixelMask tileMask;
+        PixelMask objectMask;
+    };
+    CollisionBuffers& getCollisionBuffers() { return m_collisionBuffers; }
+
+    //Whether this tile stops line of sight (anything off the map does)
+    //Read straight from the map value, so it's right however the value was set
+    bool blocksLos(int tileX, int tileY) const {
+        return tileX < 0 || tileY < 0 || tileX >= m_iMapWidth || tileY >= m_iMapHeight ||
+               TileCodes::isLosBlockingTile(getMapValue(tileX, tileY));
+    }
+    //Whether this tile is drawn over its whole area, so nothing underneath can show through (off the map isn't)
+    bool isOpaque(int tileX, int tileY) const;
+    //Checks every tile the line between two real locations passes over for anything blocking line of sight
+    bool lineOfSight(int fromX, int fromY, int toX, int toY) const;
+
 private:
     ZEngine* m_pEngine;
     shared_ptr<SimpleImage> m_tilesImage;
     shared_ptr<PixelMap> m_pixelMap;
+    shared_ptr<DistanceField> m_distanceField; //For m_pixelMap
+    mutable vector<signed char> m_opaqueValues; //For each map value, -1 until it's first checked
+    CollisionBuffers m_collisionBuffers;
 
     //Used to paint random details on chosen tiles given a specific probability (percent)
     static void paintRandomDetail(vector<shared_ptr<SimpleImage>>* images, int probability,
                                   DrawingSurface *pSurface,
-                                  int xStart, int yStart) ;
+                                  int xStart, int yStart, RandomStream& random) ;
+    //Times (along the move) that a moving span [from, to) starts and stops overlapping the tile's span on one axis
+    //False if it never overlaps
+    static bool sweepAxis(int from, int to, int tileFrom, int tileTo, int move, float& entry, float& exit);
 };
 
 
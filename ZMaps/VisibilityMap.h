@@ -0,0 +1,136 @@
+//
+// Created by Chris Greer on 07/05/2024.
+//
+
+#ifndef G52CPP_VISIBILITYMAP_H
+#define G52CPP_VISIBILITYMAP_H
+
+#include "../../header.h"
+#include <vector>
+#include "MapTileManager.h"
+
+using namespace std;
+
+//Which tiles can see the player (from the center of the player's tile)
+//Every enemy asks the same question every tick, so instead of them all casting their own ray
+//we work out everything that's visible in one pass (recursive shadowcasting) and they just look it up
+//Only needs re-calculating when the player moves onto a new tile or doors are unlocked
+class VisibilityMap {
+
+public:
+    VisibilityMap(MapTileManager* collisionMap, int tilesX, int tilesY, int tileSize)
+    : m_collisionMap(collisionMap), m_mapWidth(tilesX), m_mapHeight(tilesY), m_tileSize(tileSize){
+        m_visible.assign(m_mapWidth * m_mapHeight, false);
+    }
+
+    //Map has changed (doors unlocked), will recalculate on the next update
+    void resetMap(MapTileManager* collisionMap){
+        m_collisionMap = collisionMap;
+        m_outOfDate = true;
+    }
+
+    //Re-calculate IF the player has moved onto a different tile (or the map changed)
+    //Takes the player's real location on the map
+    void update(int playerX, int playerY){
+        int tileX = playerX / m_tileSize;
+        int tileY = playerY / m_tileSize;
+        if (!inBounds(tileX, tileY)) return;
+
+        if (!m_outOfDate && tileX == m_originX && tileY == m_originY) return; //Nothing's changed
+        m_originX = tileX;
+        m_originY = tileY;
+        m_outOfDate = false;
+        calculateVisibility();
+    }
+
+    //False until the first update (or after the map changes), callers should check for themselves until then
+    bool isUpToDate() const { return !m_outOfDate; }
+
+    //Whether the tile at this real location can see the player
+    bool canSeePlayer(int x, int y) const {
+        if (x < 0 || y < 0) return false;
+        int tileX = x / m_tileSize;
+        int tileY = y / m_tileSize;
+        return inBounds(tileX, tileY) && m_visible[nodeVal(tileX, tileY)];
+    }
+
+private:
+    void calculateVisibility(){
+        fill(m_visible.begin(), m_visible.end(), false);
+        m_visible[nodeVal(m_originX, m_originY)] = true;
+        m_radius = max(m_mapWidth, m_mapHeight);
+
+        //Transforms each octant onto the same one so the scanning code only has to be written once
+        static const int multipliers[4][8] = {
+                {1, 0, 0, -1, -1, 0, 0, 1},
+                {0, 1, -1, 0, 0, -1, 1, 0},
+                {0, 1, 1, 0, 0, -1, -1, 0},
+                {1, 0, 0, 1, -1, 0, 0, -1}
+        };
+        for (int octant = 0; octant < 8; ++octant) {
+            castLight(1, 1.0f, 0.0f,
+                      multipliers[0][octant], multipliers[1][octant],
+                      multipliers[2][octant], multipliers[3][octant]);
+        }
+    }
+
+    //Scan outwards a row at a time between the start and end slopes
+    //Each time we hit a blocking tile, the part of the row before it is scanned further on its own (recursively)
+    //and the rest carries on from the other side of the blockage
+    void castLight(int row, float start, float end, int xx, int xy, int yx, int yy){
+        if (start < end) return;
+        float newStart = 0.0f;
+        bool blocked = false;
+        for (int distance = row; distance <= m_radius && !blocked; ++distance) {
+            int deltaY = -distance;
+            for (int deltaX = -distance; deltaX <= 0; ++deltaX) {
+                int currentX = m_originX + deltaX * xx + deltaY * xy;
+                int currentY = m_originY + deltaX * yx + deltaY * yy;
+                //Slopes of the edges of this tile as seen from the origin
+                float leftSlope = (static_cast<float>(deltaX) - 0.5f) / (static_cast<float>(deltaY) + 0.5f);
+                float rightSlope = (static_cast<float>(deltaX) + 0.5f) / (static_cast<float>(deltaY) - 0.5f);
+
+                if (start < rightSlope) continue;
+                if (end > leftSlope) break;
+
+                //Off the map counts as blocking
+                bool blocking = !inBounds(currentX, currentY) || m_collisionMap->blocksLos(currentX, currentY);
+                //Only counts as seeing the player if the line to the center of the tile is clear
+                //(same as casting a ray, partly visible tiles still need to path around the corner)
+                float centerSlope = static_cast<float>(deltaX) / static_cast<float>(deltaY);
+                if (inBounds(currentX, currentY) && centerSlope <= start && centerSlope >= end)
+                    m_visible[nodeVal(currentX, currentY)] = true;
+
+                if (blocked) {
+                    if (blocking) {
+                        newStart = rightSlope; //Still in the shadow
+                        continue;
+                    }
+                    //Come out the other side of the blockage
+                    blocked = false;
+                    start = newStart;
+                } else if (blocking && distance < m_radius) {
+                    blocked = true;
+                    castLight(distance + 1, start, leftSlope, xx, xy, yx, yy);
+                    newStart = rightSlope;
+                }
+            }
+        }
+    }
+
+    int nodeVal(int x, int y) const { return x + (y * m_mapWidth); }
+    bool inBounds(int x, int y) const { return x >= 0 && y >= 0 && x < m_mapWidth && y < m_mapHeight; }
+
+private:
+    MapTileManager* m_collisionMap;
+    int m_mapWidth;
+    int m_mapHeight;
+    int m_tileSize;
+    int m_radius = 0;
+    int m_originX = -1; //Player's tile it was last calculated for
+    int m_originY = -1;
+    bool m_outOfDate = true;
+    vector<bool> m_visible;
+};
+
+#endif //G52CPP_VISIBILITYMAP_H
@@ -0,0 +1,99 @@
+//
+// Created by Chris Greer on 18/05/2024.
+//
+
+#ifndef G52CPP_WAVEBACKGROUND_H
+#define G52CPP_WAVEBACKGROUND_H
+
+#include "../../header.h"
+#include "../../DrawingSurface.h"
+#include "../ZEngine.h"
+#include "../ZUtility/DirtyRegions.h"
+#include "MapLoader.h"
+#include "MapTileManager.h"
+#include "WorldSurface.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+//The animated waves shown anywhere the map doesn't cover (past its edges, or see-through tiles)
+//Only keeps one strip of wave tiles (a tile high, a tile wider than the window), the waves repeat every tile
+//so any part of the screen at any point of the animation is just a copy from the strip shifted along
+class WaveBackground {
+
+public:
+    WaveBackground(ZEngine* pEngine, const string& mapPath) : m_period(pEngine->getTileSize()){
+        MapTileManager waves(pEngine, m_period, m_period);
+        waves.setMapSize(pEngine->getTilesX(), pEngine->getTilesY());
+        MapLoader::loadTileValues(pEngine, &waves, mapPath);
+
+        //Top row of the waves map, wrapped round if the window is wider than the map
+        int tilesAcross = (pEngine->getWindowWidth() + m_period - 1) / m_period + 1;
+        m_strip = make_shared<DrawingSurface>(pEngine);
+        m_strip->createSurface(tilesAcross * m_period, m_period);
+        m_strip->setDrawPointsFilter(nullptr);
+        m_strip->mySDLLockSurface();
+        for (int tileX = 0; tileX < tilesAcross; ++tileX) {
+            waves.virtDrawTileAt(pEngine, m_strip.get(), tileX % pEngine->getTilesX(), 0, tileX * m_period, 0);
+        }
+        m_strip->mySDLUnlockSurface();
+    }
+
+    //Moves the waves along for this time (a pixel every 20ms, same speed as the old 4 pixels every 80ms)
+    //Returns whether they've moved since last time
+    bool setTime(int time){
+        int phase = (time / 20) % m_period;
+        bool moved = phase != m_phase;
+        m_phase = phase;
+        return moved;
+    }
+
+    //The parts of this area of the screen the map doesn't completely cover, one per run of tiles along each row
+    void exposedAreas(const WorldSurface* world, const DirtyRegions::Rect& screenArea, int offsetX, int offsetY,
+                      vector<DirtyRegions::Rect>& areas) const {
+        areas.clear();
+        int tileSize = world->getTileSize();
+        int firstTileX = floorDivide(screenArea.left + offsetX, tileSize);
+        int lastTileX = floorDivide(screenArea.right - 1 + offsetX, tileSize);
+        int firstTileY = floorDivide(screenArea.top + offsetY, tileSize);
+        int lastTileY = floorDivide(screenArea.bottom - 1 + offsetY, tileSize);
+        for (int tileY = firstTileY; tileY <= lastTileY; ++tileY) {
+            int top = max(tileY * tileSize - offsetY, screenArea.top);
+            int bottom = min((tileY + 1) * tileSize - offsetY, screenArea.bottom);
+            int runStart = -1;
+            for (int tileX = firstTileX; tileX <= lastTileX + 1; ++tileX) {
+                bool exposed = tileX <= lastTileX && !world->isCovered(tileX, tileY);
+                if (exposed && runStart < 0) runStart = tileX;
+                if (exposed || runStart < 0) continue;
+                //End of a run
+                areas.push_back({max(runStart * tileSize - offsetX, screenArea.left), top,
+                                 min(tileX * tileSize - offsetX, screenArea.right), bottom});
+                runStart = -1;
+            }
+        }
+    }
+
+    //Copies the waves onto this area of the screen, a copy for each tile high band it covers
+    void draw(DrawingSurface* target, const DirtyRegions::Rect& area) const {
+        int y = area.top;
+        while (y < area.bottom) {
+            int bandTop = floorDivide(y, m_period) * m_period;
+            int height = min(bandTop + m_period, area.bottom) - y;
+            target->copyRectangleFrom(m_strip.get(), area.left, y, area.width(), height, m_phase, -bandTop);
+            y += height;
+        }
+    }
+
+private:
+    //Rounds down for negatives too (the screen can be past the top/left of the map)
+    static int floorDivide(int value, int divisor){
+        return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+    }
+
+    int m_period; //Waves repeat every tile
+    int m_phase = 0; //How far along (pixels) the waves have moved
+    shared_ptr<DrawingSurface> m_strip;
+};
+
+#endif //G52CPP_WAVEBACKGROUND_H
@@ -0,0 +1,238 @@
+//
+// Created by Chris Greer on 17/05/2024.
+//
+
+#ifndef G52CPP_WORLDSURFACE_H
+#define G52CPP_WORLDSURFACE_H
+
+#include "../../header.h"
+#include "../../DrawingSurface.h"
+#include "../../SimpleImage.h"
+#include "MapTileManager.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+using namespace std;
+
+//The whole map as it's drawn (tile layers plus anything painted on top like blood), split into square pages
+//Rather than one huge surface the size of the map, pages are only drawn the first time they're needed
+//and only so many are kept (least recently used are dropped), so memory doesn't grow with the map size
+//Tile layers and painted images are kept, so any page can be drawn again exactly the same at any time
+class WorldSurface {
+
+public:
+    //Pages are rounded to a whole number of tiles
+    WorldSurface(ZEngine* pEngine, int width, int height, int tileSize, int pageSize = 512, int maxPages = 48)
+    : m_pEngine(pEngine), m_width(width), m_height(height), m_tileSize(tileSize),
+      m_pageSize(max(1, pageSize / tileSize) * tileSize), m_maxPages(max(maxPages, 16)){
+        m_pagesX = (m_width + m_pageSize - 1) / m_pageSize;
+        m_pagesY = (m_height + m_pageSize - 1) / m_pageSize;
+        m_pages.resize(m_pagesX * m_pagesY);
+    }
+
+    //Tile maps that make up the world, drawn in this order (bottom first)
+    //Forgets all the pages and anything painted
+    void setLayers(vector<shared_ptr<MapTileManager>> layers){
+        m_layers = std::move(layers);
+        m_stamps.clear();
+        for (Page& page : m_pages) {
+            page.built = false;
+            page.stamps.clear();
+        }
+    }
+
+    //Paints an image on top of the map (top left at this real location), parts of it the mask colour aren't drawn
+    //Kept (by each page it's over) so it's painted again whenever those pages are
+    void stamp(shared_ptr<SimpleImage> image, int left, int top){
+        int stampIndex = static_cast<int>(m_stamps.size());
+        m_stamps.push_back({std::move(image), left, top});
+        const Stamp& stamp = m_stamps.back();
+        Area area{left, top, left + stamp.image->getWidth(), top + stamp.image->getHeight()};
+        forEachPage(area, [this, &stamp, &area, stampIndex](int index){
+            Page& page = m_pages[index];
+            page.stamps.push_back(stampIndex);
+            if (!page.built) return; //Will be painted when it's drawn
+            page.surface->mySDLLockSurface();
+            drawStamp(page, stamp, clip(area, pageArea(index)));
+            page.surface->mySDLUnlockSurface();
+        });
+    }
+
+    //A tile's value has changed (in its layer), draws it again along with anything painted over it
+    void redrawTile(int tileX, int tileY){
+        Area area{tileX * m_tileSize, tileY * m_tileSize, (tileX + 1) * m_tileSize, (tileY + 1) * m_tileSize};
+        forEachPage(area, [this, &area](int index){
+            if (m_pages[index].built) drawArea(m_pages[index], clip(area, pageArea(index)), true);
+        });
+    }
+
+    //Whether the map is drawn over the whole of this tile, so nothing under it (the waves) shows through
+    bool isCovered(int tileX, int tileY) const {
+        return any_of(m_layers.begin(), m_layers.end(),
+                      [tileX, tileY](const shared_ptr<MapTileManager>& layer){ return layer->isOpaque(tileX, tileY); });
+    }
+    int getTileSize() const { return m_tileSize; }
+
+    //Same as copyRectangleFrom, target location plus the offset is the real location on the map
+    //Any pages it needs that aren't there yet are drawn first
+    void copyTo(DrawingSurface* target, int left, int top, int width, int height, int offsetX, int offsetY){
+        Area area{left + offsetX, top + offsetY, left + offsetX + width, top + offsetY + height};
+        forEachPage(area, [&](int index){
+            Page& page = usePage(index);
+            Area part = clip(area, pageArea(index));
+            target->copyRectangleFrom(page.surface.get(),
+                                      part.left - offsetX, part.top - offsetY,
+                                      part.right - part.left, part.bottom - part.top,
+                                      offsetX - page.left, offsetY - page.top);
+        });
+    }
+
+    //Draws (at most) one page that isn't needed yet but is close to this area (real locations),
+    //so it's ready before it comes on screen rather than drawing several at once then
+    void prefetch(int left, int top, int width, int height, int margin){
+        Area area{left - margin, top - margin, left + width + margin, top + height + margin};
+        bool drawn = false;
+        forEachPage(area, [&](int index){
+            if (drawn || m_pages[index].built) return;
+            usePage(index);
+            drawn = true;
+        });
+    }
+
+private:
+    struct Area {
+        int left, top, right, bottom; //Right and bottom aren't included
+        bool empty() const { return left >= right || top >= bottom; }
+    };
+    struct Page {
+        shared_ptr<DrawingSurface> surface;
+        bool built = false;
+        unsigned long long lastUsed = 0;
+        int left = 0; //Real location of its top left
+        int top = 0;
+        vector<int> stamps; //Index of every stamp over this page (in m_stamps), in the order they were painted
+    };
+    struct Stamp {
+        shared_ptr<SimpleImage> image;
+        int left, top;
+    };
+
+    static Area clip(const Area& area, const Area& within){
+        return {max(area.left, within.left), max(area.top, within.top),
+                min(area.right, within.right), min(area.bottom, within.bottom)};
+    }
+
+    Area pageArea(int index) const {
+        int left = (index % m_pagesX) * m_pageSize;
+        int top = (index / m_pagesX) * m_pageSize;
+        return {left, top, min(left + m_pageSize, m_width), min(top + m_pageSize, m_height)};
+    }
+
+    //Every page an area (real locations) touches
+    template<typename Visit>
+    void forEachPage(const Area& area, Visit visit){
+        Area onMap = clip(area, {0, 0, m_width, m_height});
+        if (onMap.empty()) return;
+        for (int pageY = onMap.top / m_pageSize; pageY <= (onMap.bottom - 1) / m_pageSize; ++pageY) {
+            for (int pageX = onMap.left / m_pageSize; pageX <= (onMap.right - 1) / m_pageSize; ++pageX) {
+                visit(pageX + pageY * m_pagesX);
+            }
+        }
+    }
+
+    //The page ready to copy from, drawing it first if needed
+    Page& usePage(int index){
+        Page& page = m_pages[index];
+        page.lastUsed = ++m_useCounter;
+        if (page.built) return page;
+
+        if (!page.surface) page.surface = takeSurface();
+        Area area = pageArea(index);
+        page.left = area.left;
+        page.top = area.top;
+        drawArea(page, area, false);
+        page.built = true;
+        return page;
+    }
+
+    //A surface for a new page, either a new one or (if there's already too many) the least recently used page's
+    shared_ptr<DrawingSurface> takeSurface(){
+        int withSurface = 0;
+        Page* oldest = nullptr;
+        for (Page& page : m_pages) {
+            if (!page.surface) continue;
+            withSurface++;
+            if (!oldest || page.lastUsed < oldest->lastUsed) oldest = &page;
+        }
+        if (withSurface >= m_maxPages && oldest) {
+            shared_ptr<DrawingSurface> surface = std::move(oldest->surface);
+            oldest->surface.reset();
+            oldest->built = false;
+            surface->fillSurface(0); //Back to nothing drawn
+            return surface;
+        }
+        shared_ptr<DrawingSurface> surface = make_shared<DrawingSurface>(m_pEngine);
+        surface->createSurface(m_pageSize, m_pageSize);
+        //Page draws at its own locations, no filter (bounds check is left on to trim tiles at the page edge)
+        surface->setDrawPointsFilter(nullptr);
+        surface->setAlpha(0);
+        return surface;
+    }
+
+    //Draws the tiles and stamps in this part of the page (real locations)
+    void drawArea(Page& page, const Area& area, bool clearFirst){
+        if (area.empty()) return;
+        DrawingSurface* surface = page.surface.get();
+        surface->mySDLLockSurface();
+        if (clearFirst)
+            surface->drawRectangle(area.left - page.left, area.top - page.top,
+                                   area.right - page.left - 1, area.bottom - page.top - 1, 0);
+
+        int firstTileX = area.left / m_tileSize;
+        int firstTileY = area.top / m_tileSize;
+        int lastTileX = (area.right - 1) / m_tileSize;
+        int lastTileY = (area.bottom - 1) / m_tileSize;
+        for (const auto& layer : m_layers) {
+            for (int tileY = firstTileY; tileY <= lastTileY; ++tileY) {
+                for (int tileX = firstTileX; tileX <= lastTileX; ++tileX) {
+                    layer->virtDrawTileAt(m_pEngine, surface, tileX, tileY,
+                                          tileX * m_tileSize - page.left, tileY * m_tileSize - page.top);
+                }
+            }
+        }
+        //Just the ones over this page, painted in the same order as the first time so overlapping ones come out the same
+        for (int stampIndex : page.stamps) {
+            const Stamp& stamp = m_stamps[stampIndex];
+            Area stampArea{stamp.left, stamp.top, stamp.left + stamp.image->getWidth(), stamp.top + stamp.image->getHeight()};
+            drawStamp(page, stamp, clip(stampArea, area));
+        }
+        surface->mySDLUnlockSurface();
+    }
+
+    //Just the part of the stamp within this area (real locations)
+    static void drawStamp(Page& page, const Stamp& stamp, const Area& part){
+        if (part.empty()) return;
+        stamp.image->renderImageWithMaskAndTransparency(page.surface.get(),
+                                                        part.left - stamp.left, part.top - stamp.top,
+                                                        part.left - page.left, part.top - page.top,
+                                                        part.right - part.left, part.bottom - part.top,
+                                                        stamp.image->getPixelColour(0, 0), 100);
+    }
+
+private:
+    ZEngine* m_pEngine;
+    int m_width;
+    int m_height;
+    int m_tileSize;
+    int m_pageSize;
+    int m_maxPages;
+    int m_pagesX;
+    int m_pagesY;
+    vector<Page> m_pages;
+    vector<shared_ptr<MapTileManager>> m_layers;
+    vector<Stamp> m_stamps; //Everything painted, pages only keep the index of the ones over them
+    unsigned long long m_useCounter = 0;
+};
+
+#endif //G52CPP_WORLDSURFACE_H
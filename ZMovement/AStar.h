@@ -6,52 +6,74 @@
 #define G52CPP_ASTAR_H
 
 #include "../../header.h"
-#include <list>
+#include <cstdint>
 #include "../ZEngine.h"
 #include "../ZUtility/MathUtil.h"
 #include "../ZUtility/TileCodes.h"
+#include "../ZUtility/InfoStructs.h"
+#include "../ZUtility/Metrics.h"
+#include "NodeHeap.h"
+#include "CollisionGrid.h"
 
 using namespace std;
 
 class AStar {
 public:
-    //Grid will be one node for 3x3 tiles (for efficiency)
-    ~AStar() {
-        delete[] nodes;
-    }
+    //Grid is one node per tile, the tiles are then grouped into clusters for the hierarchical search
+    //Nodes are just their index in the grid (x + y * width), everything about them is kept in flat arrays
+    //and their neighbours are worked out from the index rather than stored
     AStar(ZEngine* pEngine, MapTileManager* collisionMap)
     : m_pEngine(pEngine), m_collisionMap(collisionMap),
     m_mapWidth(pEngine->getTilesX()),
     m_mapHeight(pEngine->getTilesY()),
     m_tileSize(pEngine->getTileSize()){
-
-        nodes = new aNode[m_mapWidth * m_mapHeight];
-        createMap();
+        initialise();
     };
-    struct aNode{
-        ~aNode() { neighbours.clear(); }
-        bool barrier = false; //Any nodes containing barriers
-        bool visited = false; //Tried already
-        float globalGoal{}; //Distance to goal all together
-        float localGoal{}; //Current distance to goal
-        int tileX{}; //Which tiles this represents
-        int tileY{};
-        vector<aNode*> neighbours{};	//All neighbors of this node
-        aNode* parent{}; //Previous node on this path
+    //Built from a snapshot of the collision map instead, used by the PathService threads
+    explicit AStar(shared_ptr<const CollisionGrid> grid)
+    : m_pEngine(nullptr), m_collisionMap(nullptr), m_grid(std::move(grid)),
+    m_mapWidth(m_grid->getTilesX()),
+    m_mapHeight(m_grid->getTilesY()),
+    m_tileSize(m_grid->getTileSize()){
+        initialise();
     };
-    void resetMap(MapTileManager* collisionMap) {
+    inline static const int m_noNode = -1; //Returned when there's no path/parent
+
+    //Re-initialise based on a new collision map
+    //If we're told which tiles changed (doors unlocking) only the clusters around them are rebuilt
+    void resetMap(MapTileManager* collisionMap, const vector<KeyTile>& changedTiles = {}) {
         m_collisionMap = collisionMap;
-        createMap(); //Re-initialse our map based on new collisionMap
+        if (changedTiles.empty()) {
+            createMap(); //Re-initialse our map based on new collisionMap
+            createClusters();
+            return;
+        }
 
+        //Update just the tiles that changed and note which clusters they're in
+        vector<bool> dirty(m_clusters.size(), false);
+        for (const auto& tile : changedTiles) {
+            if (tile.x < 0 || tile.y < 0 || tile.x >= m_mapWidth || tile.y >= m_mapHeight) continue;
+            setBarrier(nodeVal(tile.x, tile.y), checkIfBarrier(tile.x, tile.y));
+            int clusterX = tile.x / m_clusterSize;
+            int clusterY = tile.y / m_clusterSize;
+            //Entrances are shared with the neighbouring clusters so they need re-building too
+            markDirty(dirty, clusterX, clusterY);
+            markDirty(dirty, clusterX - 1, clusterY);
+            markDirty(dirty, clusterX + 1, clusterY);
+            markDirty(dirty, clusterX, clusterY - 1);
+            markDirty(dirty, clusterX, clusterY + 1);
+        }
+        for (int cluster = 0; cluster < static_cast<int>(m_clusters.size()); ++cluster)
+            if (dirty[cluster]) buildEntrances(cluster);
+        for (int cluster = 0; cluster < static_cast<int>(m_clusters.size()); ++cluster)
+            if (dirty[cluster]) buildClusterEdges(cluster);
     }
 
-    //Solve path and return pointer to the 'end' node,
+    //Solve path and return the 'end' node (m_noNode if there's no path),
     //The end node actually represents the starting point
     //This makes it easier to iterate through the parents to get the direction to go
-    aNode* solvePath(int startX, int startY, int endX, int endY){ //Will update pointer
-
-        //First reset all the nodes as doing a new search
-        resetNodes();
+    int solvePath(int startX, int startY, int endX, int endY){
+        METRICS_TIME(t_solvePath);
 
         //Get which nodes these tile values relate to
         //Our starting node is the location of the goal
@@ -59,151 +81,488 @@ public:
         int iStartNode = nodeVal(endX / (m_tileSize), endY / (m_tileSize));
         int iEndNode = nodeVal(startX / (m_tileSize), startY / (m_tileSize));
 
-        aNode *startNode = &nodes[iStartNode];
-        aNode *endNode = &nodes[iEndNode];
-        aNode *currentNode = nullptr;
+        //If we're in the same cluster then try just searching inside it first (very small search)
+        int cluster = clusterOf(iEndNode);
+        if (cluster == clusterOf(iStartNode)) {
+            int node = search(iStartNode, iEndNode, clusterBounds(cluster));
+            if (node != m_noNode) return node;
+        }
+
+        //Otherwise plan across the clusters and only do the fine search where we need it
+        return solveHierarchical(iStartNode, iEndNode);
+    }
+
+    //Jump point search, takes the same values as solvePath
+    //Straight runs are skipped over rather than added to the heap a tile at a time (the grid is uniform cost,
+    //so there are lots of equally short paths), and the path is only made up of the turning points
+    //i.e. the first parent of the returned node is where the mover needs to change direction
+    int solveJumpPoint(int startX, int startY, int endX, int endY){
+
+        int iStartNode = nodeVal(endX / (m_tileSize), endY / (m_tileSize));
+        int iEndNode = nodeVal(startX / (m_tileSize), startY / (m_tileSize));
+
+        startNewSearch();
+        touch(iStartNode);
+        touch(iEndNode);
+        if (iStartNode == iEndNode) return iEndNode;
+        if (isBarrier(iEndNode)) return m_noNode; //Would never be reached anyway
+
+        m_gCost[iStartNode] = 0.0f;
+        m_untested.clear();
+        m_untested.push(iStartNode, distanceHeuristic(iStartNode, iEndNode));
+
+        int current = m_noNode;
+        while (!m_untested.empty() && current != iEndNode) {
+            current = m_untested.pop();
+            m_closedStamp[current] = m_searchId;
+
+            int x = getTileX(current);
+            int y = getTileY(current);
+            int parent = getParent(current);
+            if (parent == m_noNode) {
+                //Start can go any way
+                relaxJump(current, jump(x, y, 0, -1, iEndNode), iEndNode);
+                relaxJump(current, jump(x, y, 0, 1, iEndNode), iEndNode);
+                relaxJump(current, jump(x, y, -1, 0, iEndNode), iEndNode);
+                relaxJump(current, jump(x, y, 1, 0, iEndNode), iEndNode);
+            } else if (getTileY(parent) == y) {
+                //Came horizontally, keep going or turn up/down
+                relaxJump(current, jump(x, y, x > getTileX(parent) ? 1 : -1, 0, iEndNode), iEndNode);
+                relaxJump(current, jump(x, y, 0, -1, iEndNode), iEndNode);
+                relaxJump(current, jump(x, y, 0, 1, iEndNode), iEndNode);
+            } else {
+                //Came vertically, keep going and only turn where something was blocking us before
+                int dy = y > getTileY(parent) ? 1 : -1;
+                relaxJump(current, jump(x, y, 0, dy, iEndNode), iEndNode);
+                if (isOpen(x - 1, y) && !isOpen(x - 1, y - dy)) relaxJump(current, jump(x, y, -1, 0, iEndNode), iEndNode);
+                if (isOpen(x + 1, y) && !isOpen(x + 1, y - dy)) relaxJump(current, jump(x, y, 1, 0, iEndNode), iEndNode);
+            }
+        }
+        if (current != iEndNode) return m_noNode;
+
+        //Jump points in the middle of a straight run aren't turning points, skip over them
+        int node = iEndNode;
+        while (getParent(node) != m_noNode) {
+            int next = getParent(node);
+            int after = getParent(next);
+            if (after != m_noNode &&
+                (getTileX(node) == getTileX(next)) == (getTileX(next) == getTileX(after)) &&
+                (getTileY(node) == getTileY(next)) == (getTileY(next) == getTileY(after))) {
+                m_parent[node] = static_cast<uint32_t>(after);
+            } else {
+                node = next;
+            }
+        }
+        return iEndNode;
+    }
+
+    //Next node along the path from the last search (m_noNode at the end)
+    int getParent(int node) const { return m_parent[node] == m_noParent ? m_noNode : static_cast<int>(m_parent[node]); }
+    //Which tile a node represents
+    int getTileX(int node) const { return node % m_mapWidth; }
+    int getTileY(int node) const { return node / m_mapWidth; }
+
+    //Converts the tile value in a node structure to the real location on map
+    int tileToLoc(int tile) const { return (tile * m_tileSize) + m_tileSize/2;};
+//    int tileToLocY(int tileX){ return tileX * nodeDim * m_tileSize;};
+private:
+    //Inclusive area of tiles a search is allowed to use
+    struct Bounds {
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    //Standard A* between two nodes, only looking at the nodes within the bounds
+    int search(int iStartNode, int iEndNode, const Bounds& bounds){
+
+        //New search, any node not stamped with this id is treated as reset
+        //(saves walking the whole grid before every search)
+        startNewSearch();
+        touch(iStartNode);
+        touch(iEndNode);
 
         //Already there, just move directly
         //Will check the line of sight so should know!
-        if (startNode->tileX == endNode->tileX && startNode->tileY == endNode->tileY) return endNode;
+        if (iStartNode == iEndNode) return iEndNode;
 
-        startNode->localGoal = 0.0f;
-        startNode->globalGoal = distanceHeuristic(startNode, endNode);
+        m_gCost[iStartNode] = 0.0f;
 
-        //Create list of nodes yet to be tested, add our starting node
-        list<aNode*> untested;
-        untested.push_back(startNode);
+        //Heap of nodes yet to be tested (ordered by global goal), add our starting node
+        m_untested.clear();
+        m_untested.push(iStartNode, distanceHeuristic(iStartNode, iEndNode));
 
         //Don't need the absolute shortest path (would increase calculations)
         //So instead of testing everything, will return if we reach end node
-        while (!untested.empty() && currentNode != endNode)
+        int current = m_noNode;
+        while (!m_untested.empty() && current != iEndNode)
         {
-            //Sort untested list based on the global goal
-            untested.sort([](const aNode* left, const aNode* right){
-                return left->globalGoal < right->globalGoal;
-            } );
-
-            //Remove any untested nodes
-            while(!untested.empty() && untested.front()->visited)
-                untested.pop_front();
-
-            //If all tested and empty, means no path!
-            if (untested.empty())
-                break;
-
             //Take the front (shortest global) node
-            currentNode = untested.front();
+            current = m_untested.pop();
             //Set it to visted (only want to explore it once)
-            currentNode->visited = true;
+            m_closedStamp[current] = m_searchId;
 
             //Check all of it's neighbours
-            for (auto neighbour : currentNode->neighbours)
-            {
-                //As long as neighbor isn't a barrier (Contains blocking tile)
-                //And it's not already been visited, add it to our untested list;
-                if (!neighbour->visited && !neighbour->barrier)
-                    untested.push_back(neighbour);
+            forEachNeighbour(current, [&](int neighbour, int x, int y){
+                //Ignore anything outside the area we're searching
+                if (x < bounds.minX || x > bounds.maxX || y < bounds.minY || y > bounds.maxY)
+                    return;
+                touch(neighbour);
+                //Don't need to consider barriers (contains blocking tile) or anything already tested
+                if (isClosed(neighbour) || isBarrier(neighbour))
+                    return;
 
                 //Calculate the potentially shorter distance
-                float potentialGoal = currentNode->localGoal + distanceHeuristic(currentNode, neighbour);
-
+                float potentialGoal = m_gCost[current] + distanceHeuristic(current, neighbour);
 
                 //If this is a shorter path than the neighbor currently has locally
                 //then update its local path value to this and set this as the current node
-                if (potentialGoal < neighbour->localGoal)
+                if (potentialGoal < m_gCost[neighbour])
                 {
-                    neighbour->parent = currentNode;
-                    neighbour->localGoal = potentialGoal;
+                    m_parent[neighbour] = static_cast<uint32_t>(current);
+                    m_gCost[neighbour] = potentialGoal;
 
-                    // Update the neighbour's global goal, will ensure only the best paths
-                    //continue to be considered (don't need to check worsening paths)
-                    neighbour->globalGoal = neighbour->localGoal + distanceHeuristic(neighbour, endNode);
+                    //Add it to be tested (or move it up the heap if it's already waiting)
+                    //Keyed on the global goal, will ensure only the best paths continue to be considered
+                    //Ties go to whichever is closer to the end (less to expand)
+                    m_untested.push(neighbour, potentialGoal + distanceHeuristic(neighbour, iEndNode), -potentialGoal);
                 }
+            });
+        }
+        return current == iEndNode ? iEndNode : m_noNode;
+    }
+
+    //Hierarchical search, first finds a route through the cluster entrances (small graph)
+    //then only refines the part of it in the mover's cluster into actual tiles
+    int solveHierarchical(int iStartNode, int iEndNode){
+
+        if (iStartNode == iEndNode) {
+            startNewSearch();
+            touch(iEndNode);
+            return iEndNode;
+        }
+        if (isBarrier(iEndNode)) return m_noNode; //Would never be reached anyway
+
+        int startCluster = clusterOf(iStartNode);
+        int endCluster = clusterOf(iEndNode);
+
+        //Link the start (player) into the graph, distances from it to each entrance in its cluster
+        clusterDistances(iStartNode, startCluster, m_distances);
+        m_startEdges.clear();
+        for (int entrance : m_clusters[startCluster].entrances) {
+            int distance = m_distances[localVal(entrance, startCluster)];
+            if (distance > 0) m_startEdges.emplace_back(entrance, distance);
+        }
+        //And the end (mover) too, only needed by the entrances of the mover's cluster
+        clusterDistances(iEndNode, endCluster, m_endDistances);
+
+        //A* over the entrances, nodes are still stamped/reset the same as a normal search
+        startNewSearch();
+        touch(iStartNode);
+        touch(iEndNode);
+        m_gCost[iStartNode] = 0.0f;
+        m_untested.clear();
+        m_untested.push(iStartNode, distanceHeuristic(iStartNode, iEndNode));
+
+        while (!m_untested.empty()) {
+            int current = m_untested.pop();
+            m_closedStamp[current] = m_searchId;
+            if (current == iEndNode) break;
+
+            int cluster = clusterOf(current);
+            int entrance = m_entranceOf[current];
+            if (current == iStartNode) {
+                for (const auto& edge : m_startEdges) relaxAbstract(current, edge.first, static_cast<float>(edge.second), iEndNode);
+            } else if (entrance != -1) {
+                const Cluster& clusterInfo = m_clusters[cluster];
+                for (const auto& edge : clusterInfo.edges[entrance])
+                    relaxAbstract(current, clusterInfo.entrances[edge.first], static_cast<float>(edge.second), iEndNode);
+            }
+            //Crossing over into the next cluster
+            if (entrance != -1) {
+                for (int partner : m_clusters[cluster].partners[entrance])
+                    relaxAbstract(current, partner, 1.0f, iEndNode);
             }
+            //Entrances in the mover's cluster (or the start if it shares it) can link straight to the mover
+            if (cluster == endCluster) {
+                int distance = m_endDistances[localVal(current, endCluster)];
+                if (distance > 0) relaxAbstract(current, iEndNode, static_cast<float>(distance), iEndNode);
+            }
+        }
+        if (!isClosed(iEndNode)) return m_noNode; //No path
+
+        //Record the route through the entrances (mover first) before we start re-using the nodes
+        m_abstractPath.clear();
+        for (int node = iEndNode; node != m_noNode; node = getParent(node))
+            m_abstractPath.push_back(node);
+
+        //Refine into tiles until we've left the mover's cluster (the mover re-plans before it gets further)
+        m_refinedPath.clear();
+        m_refinedPath.push_back(iEndNode);
+        for (int i = 0; i + 1 < static_cast<int>(m_abstractPath.size()); ++i) {
+            int from = m_abstractPath[i];
+            int to = m_abstractPath[i + 1];
+            if (clusterOf(from) != clusterOf(to)) {
+                //Stepping over a cluster border, they're next to each other
+                m_refinedPath.push_back(to);
+                break;
+            }
+            //Fine search inside this cluster only
+            int node = search(to, from, clusterBounds(clusterOf(from)));
+            if (node == m_noNode) return m_noNode; //Shouldn't happen, the edge came from this cluster
+            for (node = getParent(node); node != m_noNode; node = getParent(node))
+                m_refinedPath.push_back(node);
         }
-        if (!currentNode) return nullptr;
-        if (currentNode->tileX == endNode->tileX && currentNode->tileY == endNode->tileY)
-            return endNode;
-        else
-            return nullptr;
 
+        //Link the refined tiles together so the result can be followed the same as a normal search
+        startNewSearch();
+        for (int i = 0; i < static_cast<int>(m_refinedPath.size()); ++i) {
+            touch(m_refinedPath[i]);
+            m_parent[m_refinedPath[i]] = (i + 1 < static_cast<int>(m_refinedPath.size())) ?
+                    static_cast<uint32_t>(m_refinedPath[i + 1]) : m_noParent;
+        }
+        return iEndNode;
+    }
+
+    //Move in a straight line until we find somewhere worth stopping (a jump point), m_noNode if we hit a barrier
+    //Moving horizontally we could turn up/down anywhere, so a tile is worth stopping at if going up/down finds something
+    //Moving vertically it's only worth stopping where a gap opens up next to us that was blocked behind
+    int jump(int x, int y, int dx, int dy, int iEndNode) const {
+        while (true) {
+            x += dx;
+            y += dy;
+            if (!isOpen(x, y)) return m_noNode;
+            int node = nodeVal(x, y);
+            if (node == iEndNode) return node;
+            if (dx != 0) {
+                if (jump(x, y, 0, -1, iEndNode) != m_noNode || jump(x, y, 0, 1, iEndNode) != m_noNode)
+                    return node;
+            } else if ((isOpen(x - 1, y) && !isOpen(x - 1, y - dy)) ||
+                       (isOpen(x + 1, y) && !isOpen(x + 1, y - dy))) {
+                return node;
+            }
+        }
+    }
+
+    //Jump points are always in a straight line from each other so the cost is just the distance
+    void relaxJump(int current, int next, int iEndNode){
+        if (next != m_noNode) relaxAbstract(current, next, distanceHeuristic(current, next), iEndNode);
+    }
+
+    //Relax one edge of the cluster graph (or between jump points)
+    void relaxAbstract(int current, int next, float cost, int iEndNode){
+        touch(next);
+        if (isClosed(next) || isBarrier(next)) return;
+        float potentialGoal = m_gCost[current] + cost;
+        if (potentialGoal < m_gCost[next]) {
+            m_parent[next] = static_cast<uint32_t>(current);
+            m_gCost[next] = potentialGoal;
+            m_untested.push(next, potentialGoal + distanceHeuristic(next, iEndNode), -potentialGoal);
+        }
+    }
+
+    void initialise(){
+        int totalNodes = m_mapWidth * m_mapHeight;
+        m_barrier.assign((totalNodes + 63) / 64, 0);
+        m_gCost.assign(totalNodes, INFINITY);
+        m_parent.assign(totalNodes, m_noParent);
+        m_searchStamp.assign(totalNodes, 0);
+        m_closedStamp.assign(totalNodes, 0);
+        m_untested.resize(totalNodes);
+        createMap();
+        createClusters();
     }
 
-    //Converts the tile value in a node structure to the real location on map
-    int tileToLoc(int tile) const { return (tile * m_tileSize) + m_tileSize/2;};
-//    int tileToLocY(int tileX){ return tileX * nodeDim * m_tileSize;};
-private:
     //Set up the map based on our tile map
     void createMap(){
-       
 
         for (int x = 0; x < m_mapWidth; ++x) {
             for (int y = 0; y < m_mapHeight; ++y) {
+                setBarrier(nodeVal(x,y), checkIfBarrier(x, y));
+            }
+        }
+    }
+
+    //Calls visit(neighbour, x, y) for each node next to this one (above, below, left, right)
+    //No diagonals, enemies only move along one axis at a time
+    template<typename Visit>
+    void forEachNeighbour(int node, Visit visit) const {
+        int x = getTileX(node);
+        int y = getTileY(node);
+        if (y > 0) visit(node - m_mapWidth, x, y - 1); //Above
+        if (y < m_mapHeight - 1) visit(node + m_mapWidth, x, y + 1); //Below
+        if (x > 0) visit(node - 1, x - 1, y); //Left
+        if (x < m_mapWidth - 1) visit(node + 1, x + 1, y); //Right
+    }
+
+    //Split the map into clusters and work out their entrances and the costs between them
+    //Done once at level load (then only for the clusters that change)
+    void createClusters(){
+        m_clustersX = (m_mapWidth + m_clusterSize - 1) / m_clusterSize;
+        m_clustersY = (m_mapHeight + m_clusterSize - 1) / m_clusterSize;
+        m_clusters.assign(m_clustersX * m_clustersY, Cluster());
+        m_entranceOf.assign(m_mapWidth * m_mapHeight, -1);
+        m_distances.assign(m_clusterSize * m_clusterSize, -1);
+        m_endDistances.assign(m_clusterSize * m_clusterSize, -1);
+        m_bfsQueue.resize(m_clusterSize * m_clusterSize);
+
+        for (int cluster = 0; cluster < static_cast<int>(m_clusters.size()); ++cluster)
+            buildEntrances(cluster);
+        for (int cluster = 0; cluster < static_cast<int>(m_clusters.size()); ++cluster)
+            buildClusterEdges(cluster);
+    }
 
-                int node = nodeVal(x,y);
-                nodes[node].tileX = x;
-                nodes[node].tileY = y;
-                nodes[node].barrier = checkIfBarrier(x, y);
-                nodes[node].parent = nullptr;
-                nodes[node].visited = false;
+    //Find the entrances along all four sides of a cluster
+    void buildEntrances(int cluster){
+        Cluster& clusterInfo = m_clusters[cluster];
+        for (int entrance : clusterInfo.entrances) m_entranceOf[entrance] = -1;
+        clusterInfo.entrances.clear();
+        clusterInfo.partners.clear();
+
+        Bounds bounds = clusterBounds(cluster);
+        //Left and right sides (walking down the column)
+        if (bounds.minX > 0) scanBorder(cluster, bounds.minX, bounds.minY, 0, 1, -1, 0, bounds.maxY - bounds.minY + 1);
+        if (bounds.maxX < m_mapWidth - 1) scanBorder(cluster, bounds.maxX, bounds.minY, 0, 1, 1, 0, bounds.maxY - bounds.minY + 1);
+        //Top and bottom (walking along the row)
+        if (bounds.minY > 0) scanBorder(cluster, bounds.minX, bounds.minY, 1, 0, 0, -1, bounds.maxX - bounds.minX + 1);
+        if (bounds.maxY < m_mapHeight - 1) scanBorder(cluster, bounds.minX, bounds.maxY, 1, 0, 0, 1, bounds.maxX - bounds.minX + 1);
+    }
+
+    //Walks one side of a cluster looking for runs of open tiles on both sides of the border
+    //Short runs get one entrance in the middle, longer ones get one at each end
+    void scanBorder(int cluster, int x, int y, int stepX, int stepY, int acrossX, int acrossY, int length){
+        int runStart = -1;
+        for (int i = 0; i <= length; ++i) {
+            bool open = i < length &&
+                    !isBarrier(nodeVal(x + i * stepX, y + i * stepY)) &&
+                    !isBarrier(nodeVal(x + i * stepX + acrossX, y + i * stepY + acrossY));
+            if (open && runStart == -1) runStart = i;
+            if (open || runStart == -1) continue;
+
+            //Run has just ended
+            int runEnd = i - 1;
+            if (runEnd - runStart + 1 < 6) {
+                int middle = (runStart + runEnd) / 2;
+                addEntrance(cluster, x + middle * stepX, y + middle * stepY, acrossX, acrossY);
+            } else {
+                addEntrance(cluster, x + runStart * stepX, y + runStart * stepY, acrossX, acrossY);
+                addEntrance(cluster, x + runEnd * stepX, y + runEnd * stepY, acrossX, acrossY);
             }
+            runStart = -1;
         }
+    }
 
-        //Now link all the nodes together
+    void addEntrance(int cluster, int x, int y, int acrossX, int acrossY){
+        Cluster& clusterInfo = m_clusters[cluster];
+        int tile = nodeVal(x, y);
+        //Corner tiles can be an entrance on two sides, just give them both partners
+        if (m_entranceOf[tile] == -1) {
+            m_entranceOf[tile] = static_cast<int>(clusterInfo.entrances.size());
+            clusterInfo.entrances.push_back(tile);
+            clusterInfo.partners.emplace_back();
+        }
+        clusterInfo.partners[m_entranceOf[tile]].push_back(nodeVal(x + acrossX, y + acrossY));
+    }
 
-        for (int x = 0; x < m_mapWidth; ++x) {
-            for (int y = 0; y < m_mapHeight; ++y) {
-                int node = nodeVal(x,y);
-                if(y>0){
-                    nodes[node].neighbours.push_back(&nodes[(y - 1) * m_mapWidth + (x + 0)]); //Add above
-                    //if (x > 0) //Also add diagonally NW
-                    //    nodes[node].neighbours.push_back(&nodes[(y - 1) * m_mapWidth + (x - 1)]); //Add NW
-                    //if (x<m_mapWidth-1) //Also add diagonally NE
-                    //    nodes[node].neighbours.push_back(&nodes[(y - 1) * m_mapWidth + (x + 1)]); //Add NE
-                }
-                if(y < (m_mapHeight-1)){
-                    nodes[node].neighbours.push_back(&nodes[(y + 1) * m_mapWidth + (x + 0)]); //Add below
-                    //if (x > 0) //Also add diagonally SW
-                    //    nodes[node].neighbours.push_back(&nodes[(y + 1) * m_mapWidth + (x - 1)]); //Add SW
-                    //if (y < m_mapHeight - 1 && x < m_mapWidth-1) //Also add diagonally SE
-                    //    nodes[node].neighbours.push_back(&nodes[(y + 1) * m_mapWidth + (x + 1)]); //Add SE
-                }
-                if (x > 0){
-                    nodes[node].neighbours.push_back(&nodes[(y + 0) * m_mapWidth + (x - 1)]); //Add Left
-                }
-                if(x<m_mapWidth-1){
-                    nodes[node].neighbours.push_back(&nodes[(y + 0) * m_mapWidth + (x + 1)]); //Add right
-                }
+    //Work out the cost between every pair of entrances within a cluster
+    void buildClusterEdges(int cluster){
+        Cluster& clusterInfo = m_clusters[cluster];
+        int total = static_cast<int>(clusterInfo.entrances.size());
+        clusterInfo.edges.assign(total, {});
+        for (int from = 0; from < total; ++from) {
+            clusterDistances(clusterInfo.entrances[from], cluster, m_distances);
+            for (int to = 0; to < total; ++to) {
+                int distance = m_distances[localVal(clusterInfo.entrances[to], cluster)];
+                if (to != from && distance > 0) clusterInfo.edges[from].emplace_back(to, distance);
             }
         }
+    }
 
+    //Breadth first search inside a single cluster, fills in the number of steps to each tile (-1 if unreachable)
+    void clusterDistances(int fromTile, int cluster, vector<int>& distances){
+        fill(distances.begin(), distances.end(), -1);
+        Bounds bounds = clusterBounds(cluster);
+        int head = 0;
+        int tail = 0;
+        distances[localVal(fromTile, cluster)] = 0;
+        m_bfsQueue[tail++] = fromTile;
+        while (head < tail) {
+            int current = m_bfsQueue[head++];
+            int distance = distances[localVal(current, cluster)];
+            forEachNeighbour(current, [&](int neighbour, int x, int y){
+                if (isBarrier(neighbour) ||
+                    x < bounds.minX || x > bounds.maxX || y < bounds.minY || y > bounds.maxY)
+                    return;
+                int local = (x - bounds.minX) + (y - bounds.minY) * m_clusterSize;
+                if (distances[local] != -1) return;
+                distances[local] = distance + 1;
+                m_bfsQueue[tail++] = neighbour;
+            });
+        }
     }
+
     int nodeVal(int x, int y) const { return x + (y * m_mapWidth); }
-    //Reset/initialise nodes for a new search
-    void resetNodes(){
-        //Reset all nodes to their default values
-        //(For a fresh search)
-        for (int x = 0; x < m_mapWidth; x++)
-            for (int y = 0; y < m_mapHeight; y++)
-            {
-                int node = nodeVal(x,y);
-                nodes[node].visited = false;
-                nodes[node].globalGoal = INFINITY;
-                nodes[node].localGoal = INFINITY;
-                nodes[node].parent = nullptr;	// No parents
-            }
+    int clusterOf(int node) const {
+        return (getTileX(node) / m_clusterSize) + (getTileY(node) / m_clusterSize) * m_clustersX;
+    }
+    //Index of a tile within its cluster
+    int localVal(int node, int cluster) const {
+        Bounds bounds = clusterBounds(cluster);
+        return (getTileX(node) - bounds.minX) + (getTileY(node) - bounds.minY) * m_clusterSize;
+    }
+    Bounds clusterBounds(int cluster) const {
+        int minX = (cluster % m_clustersX) * m_clusterSize;
+        int minY = (cluster / m_clustersX) * m_clusterSize;
+        return {minX, minY,
+                min(minX + m_clusterSize, m_mapWidth) - 1,
+                min(minY + m_clusterSize, m_mapHeight) - 1};
+    }
+    void markDirty(vector<bool>& dirty, int clusterX, int clusterY) const {
+        if (clusterX < 0 || clusterY < 0 || clusterX >= m_clustersX || clusterY >= m_clustersY) return;
+        dirty[clusterX + clusterY * m_clustersX] = true;
+    }
+    //One bit per node for whether it contains a blocking tile
+    bool isBarrier(int node) const { return (m_barrier[node >> 6] >> (node & 63)) & 1; }
+    void setBarrier(int node, bool barrier){
+        if (barrier) m_barrier[node >> 6] |= (uint64_t(1) << (node & 63));
+        else m_barrier[node >> 6] &= ~(uint64_t(1) << (node & 63));
+    }
+    bool isOpen(int x, int y) const {
+        return x >= 0 && y >= 0 && x < m_mapWidth && y < m_mapHeight && !isBarrier(nodeVal(x, y));
+    }
+    //Tested already (in this search)
+    bool isClosed(int node) const { return m_closedStamp[node] == m_searchId; }
+    //Start a fresh search by moving on the search id
+    //Nodes from older searches get reset the first time this search touches them
+    void startNewSearch(){
+        m_searchId++;
+        if (m_searchId == 0) { //Wrapped round, stamps could now clash so do one full reset
+            fill(m_searchStamp.begin(), m_searchStamp.end(), 0);
+            fill(m_closedStamp.begin(), m_closedStamp.end(), 0);
+            m_searchId = 1;
+        }
+    }
+    //Reset a node to its default values if it was last used by an older search
+    void touch(int node){
+        if (m_searchStamp[node] != m_searchId) {
+            m_searchStamp[node] = m_searchId;
+            m_gCost[node] = INFINITY;
+            m_parent[node] = m_noParent; // No parents
+        }
     }
     //Calculate the distance between two nodes, will be our heuristic
-    static float distanceHeuristic(aNode* startNode, aNode* endNode)
+    float distanceHeuristic(int startNode, int endNode) const
     {
-        return static_cast<float>(abs(startNode->tileX - endNode->tileX) + abs(startNode->tileY - endNode->tileY));
+        return static_cast<float>(abs(getTileX(startNode) - getTileX(endNode)) + abs(getTileY(startNode) - getTileY(endNode)));
         //return MathUtil::fDistanceBetween(startNode->tileX,startNode->tileY,
                                           //endNode->tileX,endNode->tileY);
     }
     //Work out index of given coordinates
     //Confirm whether node contains a blocking tile
     bool checkIfBarrier(int xStart, int yStart){
-        //X/Y represents the top right corner of the 3x3 nodes
+        if (m_grid) return m_grid->isBarrier(xStart, yStart); //Working from a snapshot
+        //One node per tile, X/Y is the tile itself
         for (int x = 0; x < 1; ++x) {
             for (int y = 0; y < 1; ++y) {
                 int mapValue = m_collisionMap //Work out which tiles are within this node
@@ -217,15 +576,43 @@ private:
 
 
 private:
-    aNode* nodes = nullptr; //Unique pointer to our nodes
+    //A square group of tiles, with the tiles on its edges that lead into the neighbouring clusters
+    struct Cluster {
+        vector<int> entrances; //Tile (node) index of each entrance
+        vector<vector<int>> partners; //Tiles just over the border from each entrance
+        vector<vector<pair<int, int>>> edges; //Other entrances reachable inside the cluster (index, steps)
+    };
+
+    inline static const uint32_t m_noParent = UINT32_MAX;
+
+    //Node store, indexed by node
+    vector<uint64_t> m_barrier; //Bitset of nodes containing blocking tiles
+    vector<float> m_gCost; //Current distance from the start
+    vector<uint32_t> m_parent; //Previous node on this path (m_noParent for none)
+    vector<unsigned int> m_searchStamp; //Which search last touched each node
+    vector<unsigned int> m_closedStamp; //Which search last tested each node
+    NodeHeap m_untested; //Open set, nodes yet to be tested
+    unsigned int m_searchId = 0; //Incremented for every search (lazy reset of nodes)
     ZEngine* m_pEngine;
     MapTileManager* m_collisionMap;
+    shared_ptr<const CollisionGrid> m_grid; //Only set when built from a snapshot
     int m_mapWidth;
     int m_mapHeight;
     int m_tileSize;
 
-//    aNode* startingNode = nullptr;
-//    aNode* endingNode = nullptr; //Just set these per search?
+    //Hierarchical search
+    inline static const int m_clusterSize = 10; //Tiles along each side of a cluster
+    int m_clustersX = 0;
+    int m_clustersY = 0;
+    vector<Cluster> m_clusters;
+    vector<int> m_entranceOf; //Which entrance (within its cluster) each tile is, -1 if it isn't one
+    //Re-used between searches
+    vector<int> m_distances;
+    vector<int> m_endDistances;
+    vector<int> m_bfsQueue;
+    vector<pair<int, int>> m_startEdges;
+    vector<int> m_abstractPath;
+    vector<int> m_refinedPath;
 };
 
 
@@ -10,6 +10,9 @@
 #include "MovementUtil.h"
 #include "../ZUtility/MathUtil.h"
 #include "AStar.h"
+#include "FlowField.h"
+#include "PathService.h"
+#include "PathFollower.h"
 #include "../ZPixels/RayTrace.h"
 
 //Handles enemy movement including the call to our A* Algorithm
@@ -17,13 +20,9 @@ class AutomatedMovement : public MovementUtil {
 
 public:
     AutomatedMovement(LivingObject* mover, ZEngine * pEngine, float acceleration, float maxSpeed)
-            : MovementUtil(mover, acceleration, maxSpeed), m_pEngine(pEngine), m_aStar(pEngine->getAStar())
+            : MovementUtil(mover, acceleration, maxSpeed), m_pEngine(pEngine)
     {}
 
-    void updateAStar(AStar* newAstar) {
-        m_aStar = newAstar;
-    }
-
     //Virtual so the logic can be changed for more complicated movement
     virtual bool automateMovement(int &pCurrentX, int &pCurrentY){
 
@@ -75,53 +74,76 @@ public:
 
     }
 
-    //Use our A* implementation to work out which tile to aim for
-    AStar::aNode* calculateNodeGoal(int currentX, int currentY){
+    //Work out which tile to aim for, either from the path service, the shared flow field or our A* implementation
+    //Returns false if there's no path to the player (or it's still being solved, keep going to our old goal)
+    bool calculateNodeGoal(int currentX, int currentY, int &goalTileX, int &goalTileY){
+
+        //Solved on the worker threads, just pick up the result if it's ready
+        PathService* pathService = m_pEngine->getPathService();
+        if (m_pEngine->getPathMode() == ZEngine::p_pathService && pathService){
+            return pathService->requestGoal(currentX, currentY, bodyRadius(), goalTileX, goalTileY) == PathService::s_found;
+        }
+
+        //The flow field already knows the next step from every tile, just need to follow it
+        FlowField* flowField = m_pEngine->getFlowField();
+        if (m_pEngine->getPathMode() == ZEngine::p_flowField && flowField){
+            int tileX = currentX / m_pEngine->getTileSize();
+            int tileY = currentY / m_pEngine->getTileSize();
+            if (!flowField->isReachable(tileX, tileY)) return false;
+
+            followPath(tileX, tileY, goalTileX, goalTileY,
+                       [flowField](int &x, int &y){ return flowField->nextStep(x, y); });
+            return true;
+        }
+
+        //Only made once A* or jump point search is selected, so fetched each time rather than kept
+        AStar* aStar = m_pEngine->getAStar();
+        if (!aStar) return false;
+
+        //Jump point search only gives back the turning points, so the first one is our goal (no need to walk the path)
+        if (m_pEngine->getPathMode() == ZEngine::p_jumpPoint){
+            int node = aStar->solveJumpPoint(
+                    currentX,currentY,
+                    m_pEngine->getPlayerCoords().x,
+                    m_pEngine->getPlayerCoords().y);
+            if (node == AStar::m_noNode) return false;
+
+            int turningPoint = aStar->getParent(node);
+            if (turningPoint == AStar::m_noNode) turningPoint = node; //Already on the player's tile
+            goalTileX = aStar->getTileX(turningPoint);
+            goalTileY = aStar->getTileY(turningPoint);
+            return true;
+        }
 
         //Solve the path towards the player using our A* implementation
-        AStar::aNode * node = m_aStar->solvePath(
+        int node = aStar->solvePath(
                 currentX,currentY,
                 m_pEngine->getPlayerCoords().x,
                 m_pEngine->getPlayerCoords().y);
 
-        if (!node) return nullptr;
-        //Update our current point so it's from the center of the current tile they're on
-        currentX = m_aStar->tileToLoc(node->tileX);
-        currentY = m_aStar->tileToLoc(node->tileY);
-
-        //Will track the angle to move at
-        //Traverse the path to determine a goal to reach before checking again
-        //This is determined by if direction needs to change
-        double angle = -1;
-        while(node->parent){
-            //Get the parent node
-            AStar::aNode * parent = node->parent;
-
-            //Determine the location it represents
-            int parentX = m_aStar->tileToLoc(parent->tileX);
-            int parentY = m_aStar->tileToLoc(parent->tileY);
-
-            //Determine the angle towards this point
-            double tempAngle = DrawingSurface::getAngle(currentX,currentY,parentX,parentY);
-
-            //If the angle has changed, then exit and use the node we had previously as a local goal
-            if (angle != -1 && angle != tempAngle){
-                return node;
-            }
-            angle = tempAngle;
-            //Otherwise keep moving along the nodes
-            node = node->parent;
-
-            //Check if we can see the player at this next node
-            if (RayTrace::lineOfSightToPlayer(dynamic_cast<ZEngine *>(m_mover->getEngine()),
-                                              m_aStar->tileToLoc(node->tileX),
-                                              m_aStar->tileToLoc(node->tileY))){
-                //If so, then we can stop at that point and just move directly
-                return node;
-            }
+        if (node == AStar::m_noNode) return false;
 
-        }
-        return node;
+        //Follow the parents of the node towards the player
+        followPath(aStar->getTileX(node), aStar->getTileY(node), goalTileX, goalTileY,
+                   [aStar, &node](int &x, int &y){
+            node = aStar->getParent(node);
+            if (node == AStar::m_noNode) return false;
+            x = aStar->getTileX(node);
+            y = aStar->getTileY(node);
+            return true;
+        });
+        return true;
+    }
+
+    //Traverse the path to determine a goal to reach before checking again (see PathFollower)
+    //nextTile moves the tile it's given one step along the path (returns false at the end)
+    template<typename NextTile>
+    void followPath(int tileX, int tileY, int &goalTileX, int &goalTileY, NextTile nextTile){
+        MapTileManager* collisionMap = m_mover->getCollisionMap();
+        ZEngine* pEngine = m_pEngine;
+        PathFollower::followPath(tileX, tileY, m_pEngine->getTileSize(), bodyRadius(), goalTileX, goalTileY, nextTile,
+                                 [collisionMap](int x, int y){ return collisionMap->clearance(x, y, false, true); },
+                                 [pEngine](int x, int y){ return RayTrace::lineOfSightToPlayer(pEngine, x, y); });
     }
 
     //Work out a new goal to move towards
@@ -130,14 +152,13 @@ public:
         int currentX = m_mover->getExactRealCenterX();
         int currentY = m_mover->getExactRealCenterY();
 
-        AStar::aNode* nodeGoal = calculateNodeGoal(currentX, currentY);
-
-        if (!nodeGoal) return;
+        int goalTileX, goalTileY;
+        if (!calculateNodeGoal(currentX, currentY, goalTileX, goalTileY)) return;
 
-        //The node we have represents our goal tile to move towards before checking path again
+        //The tile we have represents our goal to move towards before checking path again
         //Work out the x and y distances to the goal
-        int deltaX = m_aStar->tileToLoc(nodeGoal->tileX) - currentX;
-        int deltaY = m_aStar->tileToLoc(nodeGoal->tileY) - currentY;
+        int deltaX = tileToLoc(goalTileX) - currentX;
+        int deltaY = tileToLoc(goalTileY) - currentY;
 
         // Make sure we only go in one direction
         //If we're trying to avoid a blockage, go in the non-dominating direction
@@ -155,8 +176,27 @@ public:
         int bufferY = deltaY > 0 ? bufferSize : -bufferSize;
 
         //For the chosen direction, set the goal, for the other direction our current position is the goal
-        m_localGoalX = (deltaX == 0) ? currentX : m_aStar->tileToLoc(nodeGoal->tileX) + bufferX;
-        m_localGoalY = (deltaY == 0) ? currentY :m_aStar->tileToLoc(nodeGoal->tileY) + bufferY;
+        m_localGoalX = (deltaX == 0) ? currentX : tileToLoc(goalTileX) + bufferX;
+        m_localGoalY = (deltaY == 0) ? currentY :tileToLoc(goalTileY) + bufferY;
+
+        //Don't let the buffer push us into a wall, pull it back until there's room for our body
+        float radius = bodyRadius();
+        MapTileManager* collisionMap = m_mover->getCollisionMap();
+        int step = max(1, bufferSize / 4);
+        for (int pulledBack = 0; pulledBack < bufferSize; pulledBack += step) {
+            if (collisionMap->clearance(m_localGoalX, m_localGoalY, false, true) >= radius) break;
+            if (deltaX != 0) m_localGoalX -= bufferX > 0 ? step : -step;
+            if (deltaY != 0) m_localGoalY -= bufferY > 0 ? step : -step;
+        }
+    }
+
+    //Roughly half our body's width (the narrow side of where we're drawn)
+    float bodyRadius() const {
+        const PixelMask* drawn = m_mover->getRotatedPixelMap(true);
+        if (!drawn || drawn->isEmpty()) return static_cast<float>(m_pEngine->getTileSize()) / 4;
+        int width = drawn->getMaxX() - drawn->getMinX() + 1;
+        int height = drawn->getMaxY() - drawn->getMinY() + 1;
+        return static_cast<float>(min(width, height)) / 2;
     }
 
     //Move towards our determined goal
@@ -227,6 +267,8 @@ public:
     }
 
 private:
+    //Centre of a tile (real location)
+    int tileToLoc(int tile) const { return (tile * m_pEngine->getTileSize()) + m_pEngine->getTileSize()/2; }
 
     void setConeDirection(double degrees){
         //Try to move in that direction within overlapping cones
@@ -239,7 +281,6 @@ private:
     }
 private:
     ZEngine* m_pEngine;
-    AStar* m_aStar;
     int m_localGoalX = -1;
     int m_localGoalY = -1;
     bool m_followingPath = false;
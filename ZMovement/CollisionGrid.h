@@ -0,0 +1,88 @@
+//
+// Created by Chris Greer on 05/05/2024.
+//
+
+#ifndef G52CPP_COLLISIONGRID_H
+#define G52CPP_COLLISIONGRID_H
+
+#include "../../header.h"
+#include <vector>
+#include <cmath>
+#include "../ZEngine.h"
+#include "../ZUtility/TileCodes.h"
+#include "../ZUtility/TileTraversal.h"
+
+using namespace std;
+
+//Snapshot of which tiles block movement and line of sight
+//Taken on the main thread whenever the map changes and never modified after that,
+//so the path finding threads can use it without touching the live tile map
+class CollisionGrid {
+
+public:
+    CollisionGrid(ZEngine* pEngine, MapTileManager* collisionMap)
+    : m_mapWidth(pEngine->getTilesX()),
+    m_mapHeight(pEngine->getTilesY()),
+    m_tileSize(pEngine->getTileSize()){
+
+        m_barrier.assign(m_mapWidth * m_mapHeight, false);
+        m_losBlocking.assign(m_mapWidth * m_mapHeight, false);
+        for (int x = 0; x < m_mapWidth; ++x) {
+            for (int y = 0; y < m_mapHeight; ++y) {
+                int mapValue = collisionMap->getMapValue(x, y);
+                m_barrier[nodeVal(x, y)] = TileCodes::isCollisionTile(mapValue);
+                m_losBlocking[nodeVal(x, y)] = TileCodes::isLosBlockingTile(mapValue);
+            }
+        }
+    }
+
+    int getTilesX() const { return m_mapWidth; }
+    int getTilesY() const { return m_mapHeight; }
+    int getTileSize() const { return m_tileSize; }
+
+    bool isBarrier(int tileX, int tileY) const {
+        return !inBounds(tileX, tileY) || m_barrier[nodeVal(tileX, tileY)];
+    }
+    //Anything off the map counts as blocking
+    bool blocksLos(int tileX, int tileY) const {
+        return !inBounds(tileX, tileY) || m_losBlocking[nodeVal(tileX, tileY)];
+    }
+
+    //Same check as MapTileManager::lineOfSight (real map locations) but against the snapshot
+    bool lineOfSight(int fromX, int fromY, int toX, int toY) const {
+        auto tileSize = static_cast<float>(m_tileSize);
+        return TileTraversal::traverse(static_cast<float>(fromX) / tileSize, static_cast<float>(fromY) / tileSize,
+                                       static_cast<float>(toX) / tileSize, static_cast<float>(toY) / tileSize,
+                                       [this](int tileX, int tileY){ return !blocksLos(tileX, tileY); });
+    }
+
+    //Same as MapTileManager::clearance with whole tiles (real map location), but against the snapshot
+    //Only looks at the tiles around it, so anything a tile or more away just gives the tile size
+    float clearance(int x, int y) const {
+        int centreTileX = x >= 0 ? x / m_tileSize : -1;
+        int centreTileY = y >= 0 ? y / m_tileSize : -1;
+        auto nearest = static_cast<float>(m_tileSize);
+        for (int tileY = max(0, centreTileY - 1); tileY <= min(m_mapHeight - 1, centreTileY + 1); ++tileY) {
+            for (int tileX = max(0, centreTileX - 1); tileX <= min(m_mapWidth - 1, centreTileX + 1); ++tileX) {
+                if (!m_barrier[nodeVal(tileX, tileY)]) continue;
+                int closestX = min(max(x, tileX * m_tileSize), (tileX + 1) * m_tileSize - 1);
+                int closestY = min(max(y, tileY * m_tileSize), (tileY + 1) * m_tileSize - 1);
+                nearest = min(nearest, static_cast<float>(hypot(closestX - x, closestY - y)));
+            }
+        }
+        return nearest;
+    }
+
+private:
+    int nodeVal(int x, int y) const { return x + (y * m_mapWidth); }
+    bool inBounds(int x, int y) const { return x >= 0 && y >= 0 && x < m_mapWidth && y < m_mapHeight; }
+
+private:
+    int m_mapWidth;
+    int m_mapHeight;
+    int m_tileSize;
+    vector<bool> m_barrier;
+    vector<bool> m_losBlocking;
+};
+
+#endif //G52CPP_COLLISIONGRID_H
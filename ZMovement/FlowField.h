@@ -0,0 +1,220 @@
+//
+// Created by Chris Greer on 03/05/2024.
+//
+
+#ifndef G52CPP_FLOWFIELD_H
+#define G52CPP_FLOWFIELD_H
+
+#include "../../header.h"
+#include <vector>
+#include "../ZEngine.h"
+#include "../ZUtility/TileCodes.h"
+#include "../ZUtility/InfoStructs.h"
+#include "NodeHeap.h"
+
+using namespace std;
+
+//Shared 'Dijkstra map' towards the player
+//Every enemy is chasing the same target, so instead of each of them running their own A* search
+//we work out the distance (and next step) from every tile to the player's tile in one pass
+//Only needs re-calculating when the player moves onto a new tile
+//Doors unlocking just repairs the part of the field they affect (Lifelong Planning A*, without a heuristic)
+class FlowField {
+
+public:
+    FlowField(ZEngine* pEngine, MapTileManager* collisionMap)
+    : m_collisionMap(collisionMap),
+    m_mapWidth(pEngine->getTilesX()),
+    m_mapHeight(pEngine->getTilesY()),
+    m_tileSize(pEngine->getTileSize()){
+
+        m_distance.assign(m_mapWidth * m_mapHeight, m_unreachable);
+        m_rhs.assign(m_mapWidth * m_mapHeight, m_unreachable);
+        m_next.assign(m_mapWidth * m_mapHeight, -1);
+        m_queue.resize(m_mapWidth * m_mapHeight);
+        m_inconsistent.resize(m_mapWidth * m_mapHeight);
+        createMap();
+    }
+
+    //Tiles have changed (doors unlocked)
+    //If we know which tiles changed then the current field is repaired around them,
+    //otherwise re-read all the barriers and flag the field as out of date
+    void resetMap(MapTileManager* collisionMap, const vector<KeyTile>& changedTiles = {}){
+        m_collisionMap = collisionMap;
+        if (changedTiles.empty()) {
+            createMap();
+            return;
+        }
+
+        for (const auto& tile : changedTiles) {
+            if (!inBounds(tile.x, tile.y)) continue;
+            int node = nodeVal(tile.x, tile.y);
+            bool barrier = TileCodes::isCollisionTile(m_collisionMap->getMapValue(tile.x, tile.y));
+            if (barrier == m_barrier[node]) continue; //Nothing different for walking
+            m_barrier[node] = barrier;
+            if (!m_outOfDate) updateNode(node);
+        }
+        //Being recalculated from scratch anyway, no point repairing it
+        if (!m_outOfDate) repairField();
+    }
+
+    //Re-calculate the field IF the player has moved onto a different tile (or the map changed)
+    //Takes the player's real location on the map
+    void update(int playerX, int playerY){
+        int tileX = playerX / m_tileSize;
+        int tileY = playerY / m_tileSize;
+        if (!inBounds(tileX, tileY)) return;
+
+        if (!m_outOfDate && tileX == m_targetX && tileY == m_targetY) return; //Nothing's changed
+        m_targetX = tileX;
+        m_targetY = tileY;
+        m_outOfDate = false;
+        calculateField();
+    }
+
+    //Whether there's a path from this tile to the player at all
+    bool isReachable(int tileX, int tileY) const {
+        return !m_outOfDate && inBounds(tileX, tileY) && m_distance[nodeVal(tileX, tileY)] != m_unreachable;
+    }
+
+    //Number of tiles away from the player (following the path)
+    int distanceToTarget(int tileX, int tileY) const {
+        return inBounds(tileX, tileY) ? m_distance[nodeVal(tileX, tileY)] : m_unreachable;
+    }
+
+    //Updates the tile to be the next step towards the player, returns false if there is no next step
+    //(i.e. already on the player's tile or can't get there)
+    bool nextStep(int &tileX, int &tileY) const {
+        if (!isReachable(tileX, tileY)) return false;
+        int next = m_next[nodeVal(tileX, tileY)];
+        if (next == -1) return false;
+        tileX = next % m_mapWidth;
+        tileY = next / m_mapWidth;
+        return true;
+    }
+
+private:
+    //Read which tiles are barriers from the collision map
+    void createMap(){
+        m_barrier.assign(m_mapWidth * m_mapHeight, false);
+        for (int x = 0; x < m_mapWidth; ++x) {
+            for (int y = 0; y < m_mapHeight; ++y) {
+                m_barrier[nodeVal(x, y)] = TileCodes::isCollisionTile(m_collisionMap->getMapValue(x, y));
+            }
+        }
+        m_outOfDate = true; //Will recalculate on next update
+    }
+
+    //Breadth first search out from the player's tile (every step costs the same)
+    //Each tile remembers which tile it was reached from, that's the next step towards the player
+    void calculateField(){
+        fill(m_distance.begin(), m_distance.end(), m_unreachable);
+        fill(m_next.begin(), m_next.end(), -1);
+        m_inconsistent.clear();
+
+        int head = 0;
+        int tail = 0;
+        int target = nodeVal(m_targetX, m_targetY);
+        m_distance[target] = 0;
+        m_queue[tail++] = target;
+
+        while (head < tail) {
+            int current = m_queue[head++];
+            int x = current % m_mapWidth;
+            int y = current / m_mapWidth;
+
+            //Same neighbour order as our A* (above, below, left, right)
+            tryNeighbour(current, x, y - 1, tail);
+            tryNeighbour(current, x, y + 1, tail);
+            tryNeighbour(current, x - 1, y, tail);
+            tryNeighbour(current, x + 1, y, tail);
+        }
+        //Every tile now agrees with its neighbours, which is where the repairs start from
+        m_rhs = m_distance;
+    }
+
+    //Work out what a tile's distance should be from its neighbours (its 'rhs')
+    //Any tile that doesn't match its current distance needs looking at again
+    void updateNode(int node){
+        int target = nodeVal(m_targetX, m_targetY);
+        if (node != target) {
+            m_rhs[node] = m_unreachable;
+            m_next[node] = -1;
+            if (!m_barrier[node]) {
+                int x = node % m_mapWidth;
+                int y = node / m_mapWidth;
+                //Same neighbour order as the full search
+                checkNeighbour(node, x, y - 1);
+                checkNeighbour(node, x, y + 1);
+                checkNeighbour(node, x - 1, y);
+                checkNeighbour(node, x + 1, y);
+            }
+        }
+        if (m_distance[node] != m_rhs[node])
+            m_inconsistent.push(node, static_cast<float>(min(m_distance[node], m_rhs[node])));
+        else
+            m_inconsistent.remove(node);
+    }
+
+    void checkNeighbour(int node, int x, int y){
+        if (!inBounds(x, y)) return;
+        int neighbour = nodeVal(x, y);
+        if (m_barrier[neighbour] || m_distance[neighbour] == m_unreachable) return;
+        if (m_distance[neighbour] + 1 < m_rhs[node]) {
+            m_rhs[node] = m_distance[neighbour] + 1;
+            m_next[node] = neighbour;
+        }
+    }
+
+    //Settle the inconsistent tiles closest first, only spreading as far as the change actually reaches
+    void repairField(){
+        while (!m_inconsistent.empty()) {
+            int node = m_inconsistent.pop();
+            if (m_distance[node] > m_rhs[node]) {
+                //Got closer (i.e. door opened), take the new distance and let the neighbours know
+                m_distance[node] = m_rhs[node];
+            } else {
+                //Got further away (or cut off), forget the old distance and work it out again
+                m_distance[node] = m_unreachable;
+                updateNode(node);
+            }
+            int x = node % m_mapWidth;
+            int y = node / m_mapWidth;
+            if (inBounds(x, y - 1)) updateNode(nodeVal(x, y - 1));
+            if (inBounds(x, y + 1)) updateNode(nodeVal(x, y + 1));
+            if (inBounds(x - 1, y)) updateNode(nodeVal(x - 1, y));
+            if (inBounds(x + 1, y)) updateNode(nodeVal(x + 1, y));
+        }
+    }
+
+    void tryNeighbour(int current, int x, int y, int &tail){
+        if (!inBounds(x, y)) return;
+        int neighbour = nodeVal(x, y);
+        //Skip barriers and anything we've already reached (BFS so first visit is the shortest)
+        if (m_barrier[neighbour] || m_distance[neighbour] != m_unreachable) return;
+        m_distance[neighbour] = m_distance[current] + 1;
+        m_next[neighbour] = current;
+        m_queue[tail++] = neighbour;
+    }
+
+    int nodeVal(int x, int y) const { return x + (y * m_mapWidth); }
+    bool inBounds(int x, int y) const { return x >= 0 && y >= 0 && x < m_mapWidth && y < m_mapHeight; }
+
+private:
+    inline static const int m_unreachable = INT32_MAX;
+    MapTileManager* m_collisionMap;
+    int m_mapWidth;
+    int m_mapHeight;
+    int m_tileSize;
+    int m_targetX = -1; //Player's tile the field was last calculated for
+    int m_targetY = -1;
+    bool m_outOfDate = true;
+    vector<bool> m_barrier;
+    vector<int> m_distance; //Steps to the player's tile
+    vector<int> m_rhs; //What each tile's distance should be based on its neighbours (matches m_distance once settled)
+    vector<int> m_next; //Index of the next tile towards the player (-1 for none)
+    vector<int> m_queue; //Re-used for the search
+    NodeHeap m_inconsistent; //Tiles whose distance needs repairing
+};
+
+#endif //G52CPP_FLOWFIELD_H
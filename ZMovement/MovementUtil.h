@@ -106,19 +106,57 @@ protected:
 
         //If we're not really moving, don't need to check anything.
         if (adjustmentX == 0 && adjustmentY == 0) return false;
-        //Check if you'd be colliding
-        if(PixelCollisionUtil::checkTileCollision(m_collisionMap, m_mover,
-                                                  adjustmentX, adjustmentY, m_isPlayer)){
-            //Would collide!
-            return false;
+
+        //First sweep our box along the move, if it doesn't touch any collision tiles we can just go
+        float contactTime;
+        int normalX, normalY;
+        if (!PixelCollisionUtil::sweepTileCollision(m_collisionMap, m_mover, adjustmentX, adjustmentY,
+                                                    contactTime, normalX, normalY) ||
+            !wouldCollide(adjustmentX, adjustmentY)){ //Touches a tile, but may not be where it's drawn
+            locationX += adjustmentX;
+            locationY += adjustmentY;
+            return true;
+        }
+
+        //Would collide! Move up to where we first touch the tile
+        int movedX = static_cast<int>(adjustmentX * contactTime);
+        int movedY = static_cast<int>(adjustmentY * contactTime);
+        if (wouldCollide(movedX, movedY)) {
+            //Already over the tile's box (pixel perfect lets us), so can't get any closer
+            movedX = 0;
+            movedY = 0;
+        }
+
+        //Then slide the rest of the way along the wall, dropping the part going into it (along the normal)
+        int slideX = normalX != 0 ? 0 : adjustmentX - movedX;
+        int slideY = normalY != 0 ? 0 : adjustmentY - movedY;
+        if (slideX != 0 || slideY != 0) {
+            //Only as far as the next tile along the wall
+            float slideTime;
+            int slideNormalX, slideNormalY;
+            if (PixelCollisionUtil::sweepTileCollision(m_collisionMap, m_mover, slideX, slideY,
+                                                       slideTime, slideNormalX, slideNormalY, movedX, movedY) &&
+                wouldCollide(movedX + slideX, movedY + slideY)) {
+                slideX = static_cast<int>(slideX * slideTime);
+                slideY = static_cast<int>(slideY * slideTime);
+            }
+            if (!wouldCollide(movedX + slideX, movedY + slideY)) {
+                movedX += slideX;
+                movedY += slideY;
+            }
         }
-        //Otherwise move!
-        locationX += adjustmentX;
-        locationY += adjustmentY;
 
+        if (movedX == 0 && movedY == 0) return false; //Completely blocked
+        locationX += movedX;
+        locationY += movedY;
         return true;
     }
 
+    //Whether we'd be colliding with a tile if we moved by this much (pixel perfect for the player)
+    bool wouldCollide(int moveX, int moveY){
+        return PixelCollisionUtil::checkTileCollision(m_collisionMap, m_mover, moveX, moveY, m_isPlayer);
+    }
+
 protected:
     MapTileManager* m_collisionMap = nullptr;
     LivingObject* m_mover = nullptr;
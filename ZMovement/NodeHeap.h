@@ -0,0 +1,122 @@
+//
+// Created by Chris Greer on 02/05/2024.
+//
+
+#ifndef G52CPP_NODEHEAP_H
+#define G52CPP_NODEHEAP_H
+
+#include "../../header.h"
+#include <vector>
+
+using namespace std;
+
+//Indexed binary min-heap used as the open set for our path searches
+//Nodes are referred to by their index in the grid, so we can look up where a node is in the heap
+//This gives us decrease-key (a shorter path was found) without having to re-sort anything
+class NodeHeap {
+
+public:
+    //Size the position lookup to the number of nodes in the grid
+    void resize(int totalNodes){
+        m_positions.assign(totalNodes, -1);
+        m_heap.clear();
+    }
+
+    bool empty() const { return m_heap.empty(); }
+    int size() const { return static_cast<int>(m_heap.size()); }
+    bool contains(int node) const { return m_positions[node] != -1; }
+
+    //Empty the heap, only touching the nodes that are still in it (not the whole grid)
+    void clear(){
+        for (const auto& entry : m_heap) m_positions[entry.node] = -1;
+        m_heap.clear();
+    }
+
+    //Add a node, or lower its key if it's already in the heap
+    void push(int node, float key, float tieBreak = 0){
+        int position = m_positions[node];
+        if (position == -1) {
+            //New entry, add to the bottom then move it up into place
+            m_heap.push_back({node, key, tieBreak});
+            m_positions[node] = static_cast<int>(m_heap.size()) - 1;
+            siftUp(static_cast<int>(m_heap.size()) - 1);
+        } else {
+            //Already waiting to be tested, update the key and move it whichever way it needs to go
+            m_heap[position].key = key;
+            m_heap[position].tieBreak = tieBreak;
+            siftUp(position);
+            siftDown(m_positions[node]);
+        }
+    }
+
+    //Take the node with the smallest key off the heap
+    int pop(){
+        int node = m_heap.front().node;
+        swapEntries(0, static_cast<int>(m_heap.size()) - 1);
+        m_heap.pop_back();
+        m_positions[node] = -1;
+        if (!m_heap.empty()) siftDown(0);
+        return node;
+    }
+
+    //Take a node out of the heap wherever it is (i.e. it no longer needs testing)
+    void remove(int node){
+        int position = m_positions[node];
+        if (position == -1) return;
+        int last = static_cast<int>(m_heap.size()) - 1;
+        swapEntries(position, last);
+        m_heap.pop_back();
+        m_positions[node] = -1;
+        if (position < last) {
+            //Whatever was moved into the gap could need to go either way
+            int moved = m_heap[position].node;
+            siftUp(position);
+            siftDown(m_positions[moved]);
+        }
+    }
+
+private:
+    struct Entry {
+        int node;
+        float key;
+        float tieBreak; //Lower wins when keys match (i.e. prefer nodes further along the path)
+    };
+
+    static bool lessThan(const Entry& left, const Entry& right){
+        return left.key < right.key || (left.key == right.key && left.tieBreak < right.tieBreak);
+    }
+
+    void swapEntries(int a, int b){
+        swap(m_heap[a], m_heap[b]);
+        m_positions[m_heap[a].node] = a;
+        m_positions[m_heap[b].node] = b;
+    }
+
+    void siftUp(int position){
+        while (position > 0) {
+            int parent = (position - 1) / 2;
+            if (!lessThan(m_heap[position], m_heap[parent])) break;
+            swapEntries(position, parent);
+            position = parent;
+        }
+    }
+
+    void siftDown(int position){
+        int total = static_cast<int>(m_heap.size());
+        while (true) {
+            int left = position * 2 + 1;
+            int right = left + 1;
+            int smallest = position;
+            if (left < total && lessThan(m_heap[left], m_heap[smallest])) smallest = left;
+            if (right < total && lessThan(m_heap[right], m_heap[smallest])) smallest = right;
+            if (smallest == position) break;
+            swapEntries(position, smallest);
+            position = smallest;
+        }
+    }
+
+    vector<Entry> m_heap;
+    vector<int> m_positions; //Where each node currently is in the heap (-1 if not in it)
+};
+
+#endif //G52CPP_NODEHEAP_H
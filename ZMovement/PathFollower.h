@@ -0,0 +1,91 @@
+//
+// Created by Chris Greer on 19/05/2024.
+//
+
+#ifndef G52CPP_PATHFOLLOWER_H
+#define G52CPP_PATHFOLLOWER_H
+
+#include "../../header.h"
+#include "../../DrawingSurface.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+//Works out how far along a path an enemy can go before it needs to check again
+//Shared by every way of finding a path (including the path service's worker threads), so it doesn't touch
+//the engine or the live map, everything it needs to know is passed in
+class PathFollower {
+
+public:
+    //Follows the path from this tile and gives the tile to head for (the local goal)
+    //Stops when the direction changes, when going straight there would bring the body closer than radius
+    //to a wall, or once the target can be seen
+    //nextTile moves the tile it's given one step along the path (returns false at the end)
+    //clearance(x, y) is how far a real location is from the nearest collision tile
+    //canSeeTarget(x, y) is whether the target can be seen from a real location
+    template<typename NextTile, typename Clearance, typename CanSeeTarget>
+    static void followPath(int tileX, int tileY, int tileSize, float radius, int &goalTileX, int &goalTileY,
+                           NextTile nextTile, Clearance clearance, CanSeeTarget canSeeTarget){
+
+        //Update our current point so it's from the center of the current tile they're on
+        int currentX = tileToLoc(tileX, tileSize);
+        int currentY = tileToLoc(tileY, tileSize);
+
+        goalTileX = tileX;
+        goalTileY = tileY;
+
+        //Will track the angle to move at
+        double angle = -1;
+        int nextX = tileX;
+        int nextY = tileY;
+        while(nextTile(nextX, nextY)){
+
+            //Determine the location it represents
+            int parentX = tileToLoc(nextX, tileSize);
+            int parentY = tileToLoc(nextY, tileSize);
+
+            //Determine the angle towards this point
+            double tempAngle = DrawingSurface::getAngle(currentX,currentY,parentX,parentY);
+
+            //If the angle has changed, then exit and use the tile we had previously as a local goal
+            if (angle != -1 && angle != tempAngle){
+                return;
+            }
+            //Also stop if we'd get closer than a body width to a wall going straight there
+            //(always take the first step though)
+            if (angle != -1 && !hasClearance(currentX, currentY, parentX, parentY, radius, clearance)){
+                return;
+            }
+            angle = tempAngle;
+            //Otherwise keep moving along the path
+            goalTileX = nextX;
+            goalTileY = nextY;
+
+            //Check if we can see the target at this next tile
+            if (canSeeTarget(parentX, parentY)){
+                //If so, then we can stop at that point and just move directly
+                return;
+            }
+        }
+    }
+
+    //Whether going straight between two real locations keeps at least this far from any collision tile
+    //Checks points along the way close enough together that the gaps between them are covered
+    template<typename Clearance>
+    static bool hasClearance(int fromX, int fromY, int toX, int toY, float radius, Clearance clearance){
+        double length = hypot(toX - fromX, toY - fromY);
+        int samples = max(1, static_cast<int>(length / max(radius, 1.0f)));
+        for (int i = 0; i <= samples; ++i) {
+            int x = fromX + (toX - fromX) * i / samples;
+            int y = fromY + (toY - fromY) * i / samples;
+            if (clearance(x, y) < radius) return false;
+        }
+        return true;
+    }
+
+private:
+    static int tileToLoc(int tile, int tileSize){ return (tile * tileSize) + tileSize/2; }
+};
+
+#endif //G52CPP_PATHFOLLOWER_H
@@ -0,0 +1,234 @@
+//
+// Created by Chris Greer on 05/05/2024.
+//
+
+#ifndef G52CPP_PATHSERVICE_H
+#define G52CPP_PATHSERVICE_H
+
+#include "../../header.h"
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "AStar.h"
+#include "CollisionGrid.h"
+#include "PathFollower.h"
+
+using namespace std;
+
+//Solves enemy paths on a pool of worker threads so the game loop doesn't have to wait for them
+//Enemies ask for the goal from their current tile, anyone on the same tile (and the same size) shares the same request,
+//requests are handed to the workers once per tick and the results are picked up on a later tick
+//Everything other than the worker threads themselves is only used from the main thread
+class PathService {
+
+public:
+    enum Status {s_pending, s_found, s_noPath};
+
+    explicit PathService(int workers = defaultWorkers()){
+        for (int i = 0; i < workers; ++i)
+            m_workers.emplace_back(&PathService::workerLoop, this);
+    }
+    ~PathService(){
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeUp.notify_all();
+        for (auto& worker : m_workers) worker.join();
+    }
+
+    //Map has changed (new level or doors unlocked), take a new snapshot to solve against
+    //Anything solved on the old map is thrown away
+    void setGrid(shared_ptr<const CollisionGrid> grid){
+        m_grid = std::move(grid);
+        startNewGeneration();
+    }
+
+    //Called once per tick with the player's real location
+    //Hands over this tick's requests and picks up anything the workers have finished
+    void update(int playerX, int playerY){
+        if (!m_grid) return;
+        m_targetX = playerX;
+        m_targetY = playerY;
+        //Player has moved onto another tile, all the old paths lead to the wrong place
+        int tile = tileIndex(playerX, playerY);
+        if (tile != m_targetTile) {
+            m_targetTile = tile;
+            startNewGeneration();
+        }
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            for (long long request : m_requested)
+                m_jobs.push_back({request, m_generation, m_grid, m_targetX, m_targetY});
+            swap(m_completed, m_collected);
+        }
+        if (!m_requested.empty()) m_wakeUp.notify_all();
+        m_requested.clear();
+
+        for (const auto& completed : m_collected) {
+            if (completed.generation == m_generation)
+                m_results[completed.request] = completed.result;
+        }
+        m_collected.clear();
+    }
+
+    //Blocks until the workers have finished everything handed to them
+    //Only for headless runs, where paths have to arrive on the same tick every time
+    void waitForWorkers(){
+        unique_lock<mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]{ return m_jobs.empty() && m_busy == 0; });
+    }
+
+    //Goal tile to head for from this real location (the furthest point along the path we can go in a straight line
+    //keeping a body of this radius clear of walls)
+    //If it hasn't been solved yet then the request is queued (once per tile and radius) and s_pending is returned
+    Status requestGoal(int fromX, int fromY, float radius, int &goalTileX, int &goalTileY){
+        if (!m_grid) return s_noPath;
+        int tile = tileIndex(fromX, fromY);
+        if (tile == -1) return s_noPath;
+
+        long long request = requestKey(tile, radius);
+        auto found = m_results.find(request);
+        if (found == m_results.end()) {
+            m_results[request] = {}; //Marks it as requested
+            m_requested.push_back(request);
+            return s_pending;
+        }
+        const Result& result = found->second;
+        if (!result.solved) return s_pending;
+        if (!result.reachable) return s_noPath;
+        goalTileX = result.goalTileX;
+        goalTileY = result.goalTileY;
+        return s_found;
+    }
+
+private:
+    struct Result {
+        bool solved = false;
+        bool reachable = false;
+        int goalTileX = 0;
+        int goalTileY = 0;
+    };
+    struct Job {
+        long long request; //Start tile and radius
+        unsigned int generation;
+        shared_ptr<const CollisionGrid> grid;
+        int targetX; //Player's real location when it was requested
+        int targetY;
+    };
+    struct Completed {
+        long long request;
+        unsigned int generation;
+        Result result;
+    };
+
+    static int defaultWorkers(){
+        //Leave a core for the game loop itself, don't need many anyway
+        int cores = static_cast<int>(thread::hardware_concurrency());
+        return max(1, min(cores - 1, 4));
+    }
+
+    //Radius is rounded to a whole pixel, so enemies of the same size share requests
+    static long long requestKey(int tile, float radius){
+        return (static_cast<long long>(tile) << 8) | min(255, max(0, static_cast<int>(radius)));
+    }
+
+    int tileIndex(int x, int y) const {
+        int tileX = x / m_grid->getTileSize();
+        int tileY = y / m_grid->getTileSize();
+        if (x < 0 || y < 0 || tileX >= m_grid->getTilesX() || tileY >= m_grid->getTilesY()) return -1;
+        return tileX + tileY * m_grid->getTilesX();
+    }
+
+    //Forget everything requested/solved so far, workers drop anything older when they finish it
+    void startNewGeneration(){
+        m_generation++;
+        m_results.clear();
+        m_requested.clear();
+        lock_guard<mutex> lock(m_mutex);
+        m_jobs.clear();
+    }
+
+    void workerLoop(){
+        //Each worker has its own search state, rebuilt whenever the snapshot changes
+        shared_ptr<const CollisionGrid> grid;
+        unique_ptr<AStar> aStar;
+        while (true) {
+            Job job;
+            {
+                unique_lock<mutex> lock(m_mutex);
+                m_wakeUp.wait(lock, [this]{ return m_stopping || !m_jobs.empty(); });
+                if (m_stopping) return;
+                job = m_jobs.front();
+                m_jobs.pop_front();
+                m_busy++;
+            }
+            if (job.grid != grid) {
+                grid = job.grid;
+                aStar = make_unique<AStar>(grid);
+            }
+            Result result = solve(*aStar, *grid, job);
+
+            lock_guard<mutex> lock(m_mutex);
+            m_completed.push_back({job.request, job.generation, result});
+            m_busy--;
+            if (m_jobs.empty() && m_busy == 0) m_idle.notify_all();
+        }
+    }
+
+    //Find the path then work out how far along it we can go before checking again
+    //Same PathFollower as every other mode, but only against the snapshot (we're on a worker thread)
+    static Result solve(AStar& aStar, const CollisionGrid& grid, const Job& job){
+        Result result;
+        result.solved = true;
+
+        auto startTile = static_cast<int>(job.request >> 8);
+        auto radius = static_cast<float>(job.request & 255);
+        int tileX = startTile % grid.getTilesX();
+        int tileY = startTile / grid.getTilesX();
+
+        int node = aStar.solvePath(aStar.tileToLoc(tileX), aStar.tileToLoc(tileY), job.targetX, job.targetY);
+        if (node == AStar::m_noNode) return result;
+        result.reachable = true;
+
+        PathFollower::followPath(tileX, tileY, grid.getTileSize(), radius, result.goalTileX, result.goalTileY,
+                                 [&aStar, &node](int &x, int &y){
+                                     node = aStar.getParent(node);
+                                     if (node == AStar::m_noNode) return false;
+                                     x = aStar.getTileX(node);
+                                     y = aStar.getTileY(node);
+                                     return true;
+                                 },
+                                 [&grid](int x, int y){ return grid.clearance(x, y); },
+                                 [&grid, &job](int x, int y){ return grid.lineOfSight(x, y, job.targetX, job.targetY); });
+        return result;
+    }
+
+private:
+    //Main thread only
+    shared_ptr<const CollisionGrid> m_grid;
+    unordered_map<long long, Result> m_results; //By start tile and radius, includes requests still being solved
+    vector<long long> m_requested; //Asked for this tick
+    vector<Completed> m_collected;
+    int m_targetTile = -1;
+    int m_targetX = 0;
+    int m_targetY = 0;
+    unsigned int m_generation = 0;
+
+    //Shared with the workers (guarded by m_mutex)
+    mutex m_mutex;
+    condition_variable m_wakeUp;
+    condition_variable m_idle; //Nothing queued or being solved
+    deque<Job> m_jobs;
+    vector<Completed> m_completed;
+    int m_busy = 0; //Jobs being solved right now
+    bool m_stopping = false;
+
+    vector<thread> m_workers;
+};
+
+#endif //G52CPP_PATHSERVICE_H
@@ -4,6 +4,7 @@
 
 #include "GameObject.h"
 #include "../ZPixels/PixelCollisionUtil.h"
+#include "../ZPixels/ImagePixelRepo.h"
 
 GameObject::GameObject(ZEngine *pEngine, int startX, int startY, std::string  path,
                        double centerOffsetX, double centerOffsetY)
@@ -60,12 +61,24 @@ void GameObject::virtDraw() {
     int drawX = getVirtX();
     int drawY = getVirtY();
 
-    //Then render the image
-    m_image->renderImageApplyingMapping(m_pEngine, m_pEngine->getForegroundSurface(),
-                                       drawX, drawY,
-                                       m_image->getWidth(), m_image->getHeight(),
-                                       m_imageMap);
-
+    //Then render the image, already rotated and masked if we can
+    const SpriteCache::Sprite* sprite = ImagePixelRepo::getSpriteCache().get(m_image.get(),
+                                                                             static_cast<int>(m_imageCenterX),
+                                                                             static_cast<int>(m_imageCenterY),
+                                                                             m_rotateAmount);
+    if (sprite == nullptr) {
+        m_image->renderImageApplyingMapping(m_pEngine, m_pEngine->getForegroundSurface(),
+                                           drawX, drawY,
+                                           m_image->getWidth(), m_image->getHeight(),
+                                           m_imageMap);
+        //Background has to be put back here next frame
+        dynamic_cast<ZEngine*>(m_pEngine)->getDirtyRegions().drawnOver(drawX, drawY, m_image->getWidth(), m_image->getHeight());
+        return;
+    }
+    sprite->draw(m_pEngine->getForegroundSurface(), drawX, drawY);
+    //Only the part actually drawn needs the background put back
+    dynamic_cast<ZEngine*>(m_pEngine)->getDirtyRegions().drawnOver(drawX + sprite->left, drawY + sprite->top,
+                                                                    sprite->width, sprite->height);
 
 }
 
@@ -88,6 +101,10 @@ bool GameObject::isAtLocation(int xVal, int yVal, bool useDefaultMap) const {
         pixelY < 0 || pixelY > m_image->getHeight())
         return false;
 
+    //If it's already been rotated we can just check the pixel
+    if (const PixelMask* rotated = getRotatedPixelMap(useDefaultMap))
+        return rotated->get(static_cast<int>(pixelX), static_cast<int>(pixelY));
+
     //Account for rotation
     m_imageMap->mapCoordinates(pixelX,pixelY,*m_image);
 
@@ -100,6 +117,55 @@ bool GameObject::isAtLocation(int xVal, int yVal, bool useDefaultMap) const {
 
 }
 
+//Sets every pixel of the mask where we're drawn, with the mask's top left at this (virtual) location
+void GameObject::fillDrawnMask(PixelMask& mask, int left, int top, bool useDefaultMap) const {
+
+    //Can copy our rotated pixel map straight in, a word at a time
+    if (const PixelMask* rotated = getRotatedPixelMap(useDefaultMap)) {
+        mask.copyFrom(*rotated, 0, 0, getVirtX() - left, getVirtY() - top, rotated->getWidth(), rotated->getHeight());
+        return;
+    }
+
+    //Only need to look where the mask and our draw area overlap
+    int startX = max(0, getVirtX() - left);
+    int startY = max(0, getVirtY() - top);
+    int endX = min(mask.getWidth(), getVirtX() + getDrawWidth() - left);
+    int endY = min(mask.getHeight(), getVirtY() + getDrawHeight() - top);
+
+    for (int y = startY; y < endY; ++y) {
+        for (int x = startX; x < endX; ++x) {
+            if (isAtLocation(left + x, top + y, useDefaultMap))
+                mask.set(x, y);
+        }
+    }
+}
+
+//Our pixel map already rotated to (roughly) our current rotation
+const PixelMask* GameObject::getRotatedPixelMap(bool useDefaultMap) const {
+    const PixelMap* pixelMap = useDefaultMap ? m_defaultPixelMap : m_pixelMap;
+    if (pixelMap == nullptr) return nullptr;
+
+    //Same as last time, no need to look it up again
+    RotatedPixelMaps& rotatedMaps = ImagePixelRepo::getRotatedPixelMaps();
+    RotatedLookup& lookup = m_rotatedLookup[useDefaultMap ? 1 : 0];
+    if (lookup.rotated != nullptr && lookup.pixelMap == pixelMap && lookup.rotation == m_rotateAmount &&
+        lookup.generation == rotatedMaps.getGeneration())
+        return lookup.rotated;
+
+    auto centreX = static_cast<int>(m_imageCenterX);
+    auto centreY = static_cast<int>(m_imageCenterY);
+    lookup.rotated = rotatedMaps.getRotated(pixelMap, *m_image, centreX, centreY, m_rotateAmount);
+    if (lookup.rotated == nullptr) {
+        //Pre-rotating is turned off, so rotate it ourselves
+        RotatedPixelMaps::build(lookup.exact, *pixelMap, *m_image, centreX, centreY, m_rotateAmount);
+        lookup.rotated = &lookup.exact;
+    }
+    lookup.pixelMap = pixelMap;
+    lookup.rotation = m_rotateAmount;
+    lookup.generation = rotatedMaps.getGeneration();
+    return lookup.rotated;
+}
+
 //Says whether the object is within this (virtual) position on the screen.
 //Overridden so we can (potentially) convert to virtual position first
 bool GameObject::virtIsPositionWithinObject( int iX, int iY ) {
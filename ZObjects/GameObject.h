@@ -58,6 +58,14 @@ public:
     //Takes into account transparency (i.e. not drawn) and the rotation of the object
     //Can set to check whether to use default pixel map (avoids flailing arms causing issues)
     bool isAtLocation(int xVal, int yVal, bool useDefaultMap = false) const;
+    //Sets every pixel of the mask where we're drawn, with the mask's top left at this (virtual) location
+    //Only looks at the part of the mask that's within our image
+    void fillDrawnMask(PixelMask& mask, int left, int top, bool useDefaultMap = false) const;
+    //Our pixel map already rotated to (roughly) our current rotation, lined up with our draw area
+    //Kept until the pixel map or rotation changes, so checking pixels of it is just reading bits
+    //If pre-rotating is turned off it's rotated exactly
+    //Null if there's no pixel map
+    const PixelMask* getRotatedPixelMap(bool useDefaultMap = false) const;
 
     //Tells you whether the object is currently on screen
     //Accounts for the HUD at the bottom of the screen
@@ -112,6 +120,17 @@ protected:
     double m_centerOffsetX = 0;
     double m_centerOffsetY = 0;
     string m_type; //Determines the type of object, used for saving and loading
+
+private:
+    //Our pixel map as it was last rotated (current and default map), only looked up again when something changes
+    struct RotatedLookup {
+        const PixelMap* pixelMap = nullptr;
+        double rotation = 0;
+        unsigned int generation = 0; //Of the pre-rotated maps, so we don't hold on to one that's been thrown away
+        const PixelMask* rotated = nullptr;
+        PixelMask exact; //Rotated ourselves when pre-rotating is turned off
+    };
+    mutable RotatedLookup m_rotatedLookup[2];
 };
 
 
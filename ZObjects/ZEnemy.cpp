@@ -6,11 +6,16 @@
 #include "StaticObjectFactory.h"
 #include "../ZUtility/MathUtil.h"
 #include "../ZMovement/AutomatedMovement.h"
+#include "../ZUtility/Random.h"
 
 using namespace std;
 
 ZEnemy::~ZEnemy(){
     delete(m_movement);
+    //Make sure the laser can't find us any more
+    if (auto* engine = dynamic_cast<ZEngine *>(m_pEngine)) {
+        engine->getEnemyGrid().remove(this);
+    }
 };
 ZEnemy::ZEnemy(ZEngine *pEngine, const string& directoryPath,
                  ObjectInfo info,
@@ -27,9 +32,12 @@ void ZEnemy::initialise() {
     //Initialise Images
     setUpImages();
     initialiseImages();
+    //Now we know where we're drawn, add ourselves to the engine's enemy grid
+    dynamic_cast<ZEngine *>(m_pEngine)->updateEnemyGrid(this);
 
     //Initialise with a random rotation
-    double randomRotation = -M_PI + static_cast<double>(rand()) / RAND_MAX * (2 * M_PI);
+    double randomRotation = -M_PI + Random::forKey(Random::r_spawn,
+            Random::key(getExactRealCenterX(), getExactRealCenterY(), 1)).nextDouble() * (2 * M_PI);
     /*cout << randomRotation << endl;
     setRotation(randomRotation);*/
 }
@@ -61,10 +69,6 @@ void ZEnemy::virtDraw(){
     if (m_armour > 0)
         drawStatBar(m_armour,80,40,0x808080,0x0CCCCC);
 }
-//Updates the astar algorithm (if needed) in their movement util
-void ZEnemy::updateAStar(AStar* newAstar){
-    m_movement->updateAStar(newAstar);
-}
 
 void ZEnemy::drawStatBar(int stat, int barSize, int yOffset, int backgroundColour, int fillColour){
 
@@ -84,6 +88,9 @@ void ZEnemy::drawStatBar(int stat, int barSize, int yOffset, int backgroundColou
     m_pEngine->getForegroundSurface()->drawThickLine(locX - halfBar, locY - yOffset,
                                                      totalLeft, locY - yOffset,
                                                      fillColour, 2);
+    //Can stick out past the image
+    dynamic_cast<ZEngine *>(m_pEngine)->getDirtyRegions().drawnOver(locX - halfBar - 2, locY - yOffset - 2,
+                                                                    barSize + 4, 5);
 
 }
 
@@ -91,6 +98,7 @@ void ZEnemy::die(){
     //Bleed out at location
     Animator::paintBlood(dynamic_cast<ZEngine*>(m_pEngine), getExactRealCenterX(), getExactRealCenterY());
     m_dead = true;
+    dynamic_cast<ZEngine*>(m_pEngine)->getEnemyGrid().remove(this); //Can't be shot or hit any more
     m_animationCounter = 0; //Reset to go back to standard pose
     m_image = (*m_deathImages)[m_animationCounter];
 }
@@ -122,7 +130,7 @@ void ZEnemy::virtDoUpdate(int iCurrentTime) {
         if (m_animationCounter == (*m_deathImages).size() - 1) {
             dynamic_cast<ZEngine *>(m_pEngine)->addToDelete(this); //Add itself to list of objects to delete
             if (m_type[0] == 'A') { //If this is an armoured zombie, drop ammo/armour at current location
-                int random = rand() % 30;
+                int random = Random::stream(Random::r_drops).nextInt(30);
                 char drop = random == 0 ? 'B' : 'R'; //Drop either ammo, or occasionally body armour
                 dynamic_cast<ZEngine *>(m_pEngine)->addToBeAdded(
                         StaticObjectFactory::createObject(dynamic_cast<ZEngine *>(m_pEngine),
@@ -144,8 +152,9 @@ void ZEnemy::virtDoUpdate(int iCurrentTime) {
         attacking = true;
         if (animateAndUpdatePixelMaps(*m_meleeImages, *m_meleePixelMaps, iCurrentTime, 100)
             && (m_animationCounter % 3 == 1)) { //Only check at certain points of the animation (Swings)
-            //Check if they're colliding
-            if (*this == *m_player) {
+            //Check if they're colliding (only bother with the pixels if our boxes overlap)
+            auto* engine = dynamic_cast<ZEngine *>(m_pEngine);
+            if (engine->getEnemyGrid().mayOverlap(this, engine->getCollisionBox(m_player)) && *this == *m_player) {
                 int crit = (m_type.at(0) == 'Z') ? 20 : 10;
                 m_player->beenHit(crit); //Hot the player
             }
@@ -160,6 +169,8 @@ void ZEnemy::virtDoUpdate(int iCurrentTime) {
         m_moving = m_movement->automateMovement(m_iCurrentScreenX, m_iCurrentScreenY);
         //If we're moving, then animate!
         if (m_moving) {
+            //Let the enemy grid know where we are now
+            dynamic_cast<ZEngine *>(m_pEngine)->updateEnemyGrid(this);
             //Update the image based on animation counter
             animateAndUpdatePixelMaps(*m_movingImages, *m_movementPixelMaps, iCurrentTime, 100);
         }
@@ -20,7 +20,6 @@ public:
            ObjectInfo info, double centerX, double centerY);
     void virtDoUpdate(int iCurrentTime) override;
     void beenHit(int critDistance) override = 0 ; //Keep it virtual to be implemented by specific enemies
-    void updateAStar(AStar* newAstar);
 protected:
     void drawStatBar(int stat, int barSize, int yOffset, int backgroundColour, int fillColour);
     void setUpImages();
@@ -60,12 +60,9 @@ void ZPlayer::virtDraw() {
     //Call base class method
     LivingObject::virtDraw();
 
-    //Draw the laser pointer too
-    if (!m_melee && !m_rotationBlocked){
-        int offset = m_currentWeapon == w_pistol ? pistolXOffset : rifleXOffset;
-        int rotationOffset = m_currentWeapon == w_pistol ? pistolYOffset : rifleYOffset;
-        RayTrace::playerLineOfSight(this, dynamic_cast<ZEngine *>(m_pEngine), offset, rotationOffset);
-    }
+    //Draw the laser pointer too (worked out when updating)
+    if (!m_melee && !m_rotationBlocked)
+        RayTrace::drawLaser(dynamic_cast<ZEngine *>(m_pEngine), m_laser);
 
 }
 //Change to account for multiple weapons
@@ -168,8 +165,8 @@ void ZPlayer::virtDoUpdate(int iCurrentTime) {
     double previousRotation = m_rotateAmount;
     m_rotateAmount = MathUtil::rotation(getExactRealCenterX(),
                                             getExactRealCenterY(),
-                                            getEngine()->getCurrentMouseX(),
-                                            getEngine()->getCurrentMouseY(),
+                                            dynamic_cast<ZEngine *>(m_pEngine)->getGameMouseX(),
+                                            dynamic_cast<ZEngine *>(m_pEngine)->getGameMouseY(),
                                             m_initialRotation);
     //Rotate
     setRotation(m_rotateAmount);
@@ -182,6 +179,13 @@ void ZPlayer::virtDoUpdate(int iCurrentTime) {
         m_rotationBlocked = false;
     }
     //If so rotate back...
+
+    //Work out what we're aiming at now we've rotated (same as it used to be when drawing)
+    if (!m_melee && !m_rotationBlocked){
+        int offset = m_currentWeapon == w_pistol ? pistolXOffset : rifleXOffset;
+        int rotationOffset = m_currentWeapon == w_pistol ? pistolYOffset : rifleYOffset;
+        RayTrace::playerLineOfSight(this, dynamic_cast<ZEngine *>(m_pEngine), offset, rotationOffset, m_laser);
+    }
 }
 
 void ZPlayer::setMoving(bool mMoving) { m_moving = mMoving; }
@@ -10,6 +10,7 @@
 #include "../ZUtility/Animator.h"
 #include "../ZPixels/ImageLoader.h"
 #include "../ZUtility/InfoStructs.h"
+#include "../ZUtility/Random.h"
 
 using namespace std;
 
@@ -32,7 +33,7 @@ public:
     void melee();
     void switchWeapon();
     void beenHit(int critDistance) override;
-    void reload(){ m_rifleAmmo+= (rand() % 10) + 10; } //Random amount between 10 - 20
+    void reload(){ m_rifleAmmo+= Random::stream(Random::r_pickups).nextInt(10) + 10; } //Random amount between 10 - 20
     void heal(){ m_health = min(m_health + 50, 100); } // +50 up to maximum
     void armor(){ m_armour = 100; } // Fully re-armors
     Weapon getWeapon() const {return m_currentWeapon;}
@@ -50,6 +51,7 @@ private:
     int rifleXOffset = 12;
     int rifleYOffset = 20;
     bool m_melee = false;
+    LaserLine m_laser; //Worked out each update, drawn in virtDraw
     shared_ptr<vector<shared_ptr<SimpleImage>>> m_shootingImages = nullptr;
     shared_ptr<vector<shared_ptr<SimpleImage>>> m_idlePistol = nullptr;
     shared_ptr<vector<shared_ptr<SimpleImage>>> m_idleRifle = nullptr;
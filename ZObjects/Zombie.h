@@ -9,6 +9,7 @@
 #include "ZEnemy.h"
 #include "../ZMovement/AutomatedMovement.h"
 #include "../ZUtility/InfoStructs.h"
+#include "../ZUtility/Random.h"
 
 using namespace std;
 //Standard Zombie Class
@@ -22,8 +23,9 @@ public:
 
         //Determine which skin to use
         if (info.typeKey == -1)
-            //If it's a random type then choose a random number
-            m_type = info.type + to_string(rand() % totalSkins);
+            //If it's a random type then choose a random number (by where it starts, so the same every time)
+            m_type = info.type + to_string(Random::forKey(Random::r_spawn, Random::key(info.x, info.y))
+                                                   .nextInt(totalSkins));
         else //Otherwise type is set.
             m_type = info.type + to_string(info.typeKey);
 
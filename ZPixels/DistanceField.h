@@ -0,0 +1,134 @@
+//
+// Created by Chris Greer on 11/05/2024.
+//
+
+#ifndef G52CPP_DISTANCEFIELD_H
+#define G52CPP_DISTANCEFIELD_H
+
+#include "../../header.h"
+#include <vector>
+#include <cmath>
+#include "PixelMask.h"
+
+using namespace std;
+
+//Signed distance field for a pixel mask, how far each pixel is from the nearest drawn one
+//Positive outside (distance to the nearest drawn pixel), negative inside (distance to the nearest undrawn one)
+//The mask can be split into cells (e.g. the tiles of an atlas), distances never cross from one cell into another
+class DistanceField {
+
+public:
+    DistanceField() = default;
+
+    DistanceField(const PixelMask& mask, int cellWidth, int cellHeight)
+    : m_width(mask.getWidth()), m_height(mask.getHeight()){
+        m_distances.assign(m_width * m_height, INFINITY);
+        for (int cellY = 0; cellY < m_height; cellY += cellHeight) {
+            for (int cellX = 0; cellX < m_width; cellX += cellWidth) {
+                buildCell(mask, cellX, cellY, min(cellWidth, m_width - cellX), min(cellHeight, m_height - cellY));
+            }
+        }
+    }
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    //Distance to the nearest drawn pixel in the same cell (infinite if there isn't one, or out of bounds)
+    //0 or less means this pixel is drawn
+    float distance(int x, int y) const {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) return INFINITY;
+        return m_distances[x + y * m_width];
+    }
+
+private:
+    //Exact euclidean distances, done as a pass down each column then along each row (Felzenszwalb & Huttenlocher)
+    void buildCell(const PixelMask& mask, int left, int top, int width, int height){
+        vector<float> toDrawn(width * height);
+        vector<float> toUndrawn(width * height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                bool drawn = mask.get(left + x, top + y);
+                toDrawn[x + y * width] = drawn ? 0 : m_far;
+                toUndrawn[x + y * width] = drawn ? m_far : 0;
+            }
+        }
+        transform2D(toDrawn, width, height);
+        transform2D(toUndrawn, width, height);
+
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int i = x + y * width;
+                float distance = toDrawn[i] > 0 ? root(toDrawn[i]) : -root(toUndrawn[i]);
+                m_distances[(left + x) + (top + y) * m_width] = distance;
+            }
+        }
+    }
+
+    //Turns 0 (on) / m_far (off) into squared distances to the nearest 0
+    void transform2D(vector<float>& grid, int width, int height){
+        int longest = max(width, height);
+        m_line.resize(longest);
+        m_result.resize(longest);
+        m_hull.resize(longest);
+        m_bounds.resize(longest + 1);
+
+        for (int x = 0; x < width; ++x) {
+            for (int y = 0; y < height; ++y) m_line[y] = grid[x + y * width];
+            transform1D(height);
+            for (int y = 0; y < height; ++y) grid[x + y * width] = m_result[y];
+        }
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) m_line[x] = grid[x + y * width];
+            transform1D(width);
+            for (int x = 0; x < width; ++x) grid[x + y * width] = m_result[x];
+        }
+    }
+
+    //Lower envelope of the parabolas rooted at each point of the line
+    void transform1D(int length){
+        int k = 0;
+        m_hull[0] = 0;
+        m_bounds[0] = -m_far;
+        m_bounds[1] = m_far;
+        for (int q = 1; q < length; ++q) {
+            float s = intersect(q, m_hull[k]);
+            //Drop any parabolas this one hides (the first bound is so low it always stops there)
+            while (s <= m_bounds[k]) {
+                k--;
+                s = intersect(q, m_hull[k]);
+            }
+            k++;
+            m_hull[k] = q;
+            m_bounds[k] = s;
+            m_bounds[k + 1] = m_far;
+        }
+        k = 0;
+        for (int q = 0; q < length; ++q) {
+            while (m_bounds[k + 1] < static_cast<float>(q)) k++;
+            int v = m_hull[k];
+            m_result[q] = static_cast<float>((q - v) * (q - v)) + m_line[v];
+        }
+    }
+
+    //Where the parabolas rooted at q and v cross
+    float intersect(int q, int v) const {
+        return ((m_line[q] + static_cast<float>(q * q)) - (m_line[v] + static_cast<float>(v * v))) /
+               static_cast<float>(2 * q - 2 * v);
+    }
+
+    //Anything still at (about) m_far never found a pixel
+    float root(float squared) const { return squared >= m_far / 2 ? INFINITY : sqrt(squared); }
+
+private:
+    inline static const float m_far = 1e20f;
+    int m_width = 0;
+    int m_height = 0;
+    vector<float> m_distances;
+    //Working space for the transforms
+    vector<float> m_line;
+    vector<float> m_result;
+    vector<int> m_hull;
+    vector<float> m_bounds;
+};
+
+#endif //G52CPP_DISTANCEFIELD_H
@@ -8,6 +8,9 @@
 #include "ImageLoader.h"
 #include "../../header.h"
 #include "PixelMapCreator.h"
+#include "RotatedPixelMaps.h"
+#include "SpriteCache.h"
+#include "DistanceField.h"
 #include <sstream>
 
 using namespace std;
@@ -20,19 +23,24 @@ class ImagePixelRepo{
 
 public:
     
-    static void initialise(){
+    //Tile size is needed to split up the tiles image
+    static void initialise(int tileSize = 64){
 
         //Set up our maps
         m_singleImages = make_unique<map<string, shared_ptr<SimpleImage>>>();
         m_singlePixelMaps = make_unique<map<string, shared_ptr<PixelMap>>>();
         m_multiImages = make_unique<map<string, shared_ptr<vector<shared_ptr<SimpleImage>>>>>();
         m_multiPixelMaps = make_unique<map<string, shared_ptr<vector<PixelMap>>>>();
+        //How many angles the pixel maps get pre-rotated to for collisions (accuracy vs memory)
+        m_rotatedPixelMaps.setSteps(m_rotationSteps);
 
         string path = "./resources/";
 
 
         //Load our tileMap image
         loadSingleImage(path + "TileMaps/TilesImage.png", "Tiles",true);
+        //And how far every pixel of it is from a solid one (within its own tile)
+        m_tileDistanceField = make_shared<DistanceField>(*m_singlePixelMaps->at("Tiles"), tileSize, tileSize);
 
         //Load our Level Maps
         loadSingleImage(path + "TileMaps/LevelOne/Map.jpeg", "LevelOne");
@@ -69,6 +77,15 @@ public:
     static map<string, shared_ptr<PixelMap>>* getSinglePixelMaps(){return m_singlePixelMaps.get();};
     static map<string, shared_ptr<vector<shared_ptr<SimpleImage>>>>* getMultiImages(){ return m_multiImages.get();};
     static map<string, shared_ptr<vector<PixelMap>>>* getMultiPixelMaps(){return m_multiPixelMaps.get();};
+    static RotatedPixelMaps& getRotatedPixelMaps(){ return m_rotatedPixelMaps; }
+    static SpriteCache& getSpriteCache(){ return m_spriteCache; }
+    static shared_ptr<DistanceField> getTileDistanceField(){ return m_tileDistanceField; }
+    //Change how many angles pixel maps (and sprites) are pre-rotated to (0 turns it off), throws away any already rotated
+    static void setRotationSteps(int steps){
+        m_rotationSteps = steps;
+        m_rotatedPixelMaps.setSteps(steps);
+        m_spriteCache.setSteps(steps);
+    }
 
 private:
     static void loadDirectory(const string& directoryName, const string& keyString,
@@ -146,6 +163,10 @@ public:
             pair.second.reset();
         }
         m_multiPixelMaps.reset();
+
+        m_rotatedPixelMaps.clear();
+        m_spriteCache.clear(); //Keyed by the images just thrown away
+        m_tileDistanceField.reset();
     }
 
 private:
@@ -157,5 +178,11 @@ private:
     static inline unique_ptr<map<string, shared_ptr<SimpleImage>>> m_singleImages;
     //All the single pixel maps
     static inline unique_ptr<map<string, shared_ptr<PixelMap>>> m_singlePixelMaps;
+    //The pixel maps rotated for collisions
+    static inline int m_rotationSteps = 64;
+    static inline RotatedPixelMaps m_rotatedPixelMaps;
+    static inline SpriteCache m_spriteCache;
+    //Signed distance field for the tiles image
+    static inline shared_ptr<DistanceField> m_tileDistanceField;
 };
 #endif //G52CPP_IMAGEPIXELREPO_H
@@ -12,6 +12,7 @@
 #include "../ZUtility/TileCodes.h"
 #include "../ZObjects/ZEnemy.h"
 #include "ImageLoader.h"
+#include "../ZUtility/Metrics.h"
 
 //Class that handles checking for pixel perfect collision
 class PixelCollisionUtil{
@@ -19,22 +20,16 @@ class PixelCollisionUtil{
 public:
     //Checks collision with the player and ALL enemies
     //Used for player melee
-    static void checkAllEnemyCollisions(GameObject* player, ZEngine *pEngine){
-
-        //Iterate through the enemy objects to see if any collisions occurred
-        int i = 0;
-        while(true){
-            DisplayableObject* object = pEngine->getDisplayableObject(i++);
-            if (!object)  break; //Have reached the end of the array.
-            auto* target = dynamic_cast<ZEnemy *>(object);
-            if(!target) //First check the cast worked
-                continue;
-            //Then check if target is still alive, visable and on screen
+    static void checkAllEnemyCollisions(LivingObject* player, ZEngine *pEngine){
+
+        //Only the enemies whose boxes overlap ours (where we are now) could be hit
+        vector<ZEnemy*> candidates;
+        pEngine->getEnemyGrid().query(pEngine->getCollisionBox(player), candidates);
+
+        for (ZEnemy* target : candidates) {
+            //Check if target is still alive, visable and on screen
             if (!target->isVisible() || target->isDead() || !target->isInScreen())
                 continue;
-            //Then check if they're close enough that they could concievably collide
-            if (*player - *target > player->getDrawWidth() || *player - *target > player->getDrawHeight())
-                continue;
 
             //If close enough, check for specific pixel collision
             if (*player == *target){
@@ -49,21 +44,30 @@ public:
 
     //Checks if two objects' pixel maps are colliding
     static bool checkObjectCollision(const GameObject* checker, const GameObject* target){
-
-        //First get checking object's (virtual) location on the map
-        int attX = checker->getVirtX();
-        int attY = checker->getVirtY();
-
-        //Now, iterate over the checking object's draw area and check
-        //If there are any points where they are both drawn
-        for (int x = attX; x < attX + checker->getDrawWidth(); ++x) {
-            for (int y = attY; y < attY + checker->getDrawWidth(); ++y) {
-                if (checker->isAtLocation(x, y) && target->isAtLocation(x, y)){
+        METRICS_TIME(t_objectCollision);
+
+        //Only the (virtual) area both objects are drawn over can collide
+        int left = max(checker->getVirtX(), target->getVirtX());
+        int top = max(checker->getVirtY(), target->getVirtY());
+        int right = min(checker->getVirtX() + checker->getDrawWidth(), target->getVirtX() + target->getDrawWidth());
+        int bottom = min(checker->getVirtY() + checker->getDrawHeight(), target->getVirtY() + target->getDrawHeight());
+        if (left >= right || top >= bottom) return false;
+
+        //Both already rotated (once per rotation, not per check), so just line them up and check 64 pixels at a time
+        const PixelMask* checkerRotated = checker->getRotatedPixelMap();
+        const PixelMask* targetRotated = target->getRotatedPixelMap();
+        if (checkerRotated && targetRotated)
+            return checkerRotated->overlaps(*targetRotated,
+                                            target->getVirtX() - checker->getVirtX(),
+                                            target->getVirtY() - checker->getVirtY());
+
+        //Otherwise (no pixel maps) check each pixel of that area, stopping at the first one both are drawn on
+        for (int y = top; y < bottom; ++y) {
+            for (int x = left; x < right; ++x) {
+                if (checker->isAtLocation(x, y) && target->isAtLocation(x, y))
                     return true;
-                }
             }
         }
-
         return false;
     }
 
@@ -72,46 +76,80 @@ public:
     //For enemies we only care about whether they (would be) on the tile
     static bool checkTileCollision(MapTileManager* tileMap, LivingObject *object,
                                    int adjX = 0, int adjY = 0, bool isPlayer = true){
+        METRICS_TIME(t_tileCollision);
 
 
         //Need to check whether the object is over any drawn point in the tile
         //First get objects (virtual) location on the map plus any adjustment
         int objX = object->getVirtX() + adjX;
-        int objY = object->getVirtY() + adjX;
-
-        //Now, iterate over the attackers draw area and check
-        //If there are points where both are drawn
-        for (int x = objX; x < objX + object->getDrawWidth(); ++x) {
-            for (int y = objY; y < objY + object->getDrawWidth(); ++y) {
-                if (object->isAtLocation(x - adjX,y - adjY, true)){ //Check at original location
-                    //Check tile value for location
-
-                    int mapValue = tileMap->getMapValueForScreenLocation(x, y);
-                    if(TileCodes::isCollisionTile(mapValue)){
-                        if (!isPlayer) //If it's not the player we only care about being on the tile
-                            return true;
-                        //For player check if actually drawn there
-                        if (tileMap->pixelIsAt(x,y))
-                            return true;
-                    }
-                }
-            }
+        int objY = object->getVirtY() + adjY;
+        int width = object->getDrawWidth();
+        int height = object->getDrawHeight();
+
+        //Where the object is drawn in that box (default map, so animations don't suddenly collide)
+        const PixelMask* drawn = object->getRotatedPixelMap(true);
+
+        //If everything around us is further away than the furthest drawn pixel from the middle then can't be colliding
+        if (drawn) {
+            if (drawn->isEmpty()) return false;
+            float halfWidth = (drawn->getMaxX() - drawn->getMinX() + 1) / 2.0f;
+            float halfHeight = (drawn->getMaxY() - drawn->getMinY() + 1) / 2.0f;
+            int centreX = objX + static_cast<int>(drawn->getMinX() + halfWidth);
+            int centreY = objY + static_cast<int>(drawn->getMinY() + halfHeight);
+            if (tileMap->clearance(centreX, centreY, isPlayer) > hypot(halfWidth, halfHeight) + 1)
+                return false;
         }
 
-        return false;
+        //Which parts of the box it would be drawn over are solid
+        //If there's no collision tiles under it at all then nothing more to check
+        //The map's own buffers, so we're not allocating every check
+        MapTileManager::CollisionBuffers& buffers = tileMap->getCollisionBuffers();
+        PixelMask& tileMask = buffers.tileMask;
+        PixelMask& objectMask = buffers.objectMask;
+        tileMask.reset(width, height);
+        if (!tileMap->fillCollisionMask(tileMask, objX, objY, isPlayer))
+            return false;
+
+        //Line up where the object is drawn with that box
+        if (!drawn || drawn->getWidth() != width || drawn->getHeight() != height) {
+            objectMask.reset(width, height);
+            object->fillDrawnMask(objectMask, objX - adjX, objY - adjY, true); //Check at original location
+            drawn = &objectMask;
+        }
+
+        //Then check if there are points where both are drawn, a block of words at a time
+        return tileMask.overlapsSameSize(*drawn);
+    }
+
+    //Broadphase for moving, sweeps the box around where the object is drawn along the move against the collision tiles
+    //If this is false then the move can't collide (so no need to check pixels)
+    //Otherwise gives how far along the move (0 to 1) it first touches a tile and which side
+    //Can start the move from somewhere other than where the object is now (by this much)
+    static bool sweepTileCollision(MapTileManager* tileMap, LivingObject *object, int moveX, int moveY,
+                                   float& contactTime, int& normalX, int& normalY, int startX = 0, int startY = 0){
+
+        //Just the part of the draw area that's actually drawn on if we know it
+        int left = object->getVirtX() + startX;
+        int top = object->getVirtY() + startY;
+        int width = object->getDrawWidth();
+        int height = object->getDrawHeight();
+        const PixelMask* drawn = object->getRotatedPixelMap(true);
+        if (drawn) {
+            if (drawn->isEmpty()) return false;
+            left += drawn->getMinX();
+            top += drawn->getMinY();
+            width = drawn->getMaxX() - drawn->getMinX() + 1;
+            height = drawn->getMaxY() - drawn->getMinY() + 1;
+        }
+
+        return tileMap->sweepCollisionTiles(left, top, width, height, moveX, moveY, contactTime, normalX, normalY);
     }
 
     //Check if a specified pixel is set in the map (need to pass it values that account for screen location)
     static bool checkPixel(PixelMap* pixelMap, int x, int y) {
 
-        //First check if it's in bounds
-        if ( x < 0 || x >= pixelMap->at(0).size() || y < 0 || y >= pixelMap->size()) {
-            return false;
-        }
-
-        //Then check if that pixel is set or not
-        //return (*pixelMap)[y][x] != 0;
-        return pixelMap->at(y)[x];
+        //Out of bounds counts as not set
+        return pixelMap->get(x, y);
     }
 };
 
@@ -8,35 +8,39 @@
 #include "../../header.h"
 #include <vector>
 #include "../../SimpleImage.h"
+#include "PixelMask.h"
 
 using namespace std;
-//Define our pixel Map (2d array/vector of bools)
-using PixelMap = vector<vector<bool>>;
+//Define our pixel Map (bit packed mask of which pixels are drawn)
+using PixelMap = PixelMask;
 //Used to create pixel maps for each pixel that isn't a transparent background
 //Used for game objects and images to allow for pixel perfect collision detection
 class PixelMapCreator{
 public:
 
-    //Creates and returns a 2d array of booleans indicating either coloured or not
+    //Creates and returns a mask with each pixel set if it's coloured
     static PixelMap createPixelMap(const shared_ptr<SimpleImage>& m_image, int maskColour) {
 
         int width = m_image->getWidth();
         int height = m_image->getHeight();
 
-        auto pixelMap = PixelMap(height, vector<bool>(width));
+        auto pixelMap = PixelMap(width, height);
 
         //Iterate through each pixel
         for (int y = 0; y < height; ++y) {
             for (int x = 0; x < width; ++x) {
-                ///If it matches the mask colour then false, otherwise true
-                pixelMap[y][x] = m_image->getPixelColour(x, y) != maskColour;
+                ///If it matches the mask colour then leave it unset
+                if (m_image->getPixelColour(x, y) != maskColour)
+                    pixelMap.set(x, y);
             }
         }
+        //Coarse levels so overlap checks can skip the empty parts
+        pixelMap.buildLevels();
 
         return pixelMap;
 
     }
-    //Creates an array of pointers to pixel maps (which are in turn arrays of arrays of bools!)
+    //Creates an array of pixel maps (one for each image)
     static shared_ptr<vector<PixelMap>> createPixelMaps(const vector<shared_ptr<SimpleImage>>& images,
                                                         int maskColour) {
         vector<PixelMap> pixelMaps;
@@ -75,16 +79,18 @@ public:
         int intCentreY = static_cast<int>(height * centreY);
 
         //Create a pixel map for the bottom half
-        auto pixelMap = PixelMap(height, vector<bool>(width));
+        auto pixelMap = PixelMap(width, height);
 
         //Iterate through each pixel from the middle to the bottom
         for (int y = intCentreY; y < height; ++y) {
             for (int x = 0; x < width; ++x) {
-                ///If it matches the mask colour then false, otherwise true
+                ///If it matches the mask colour then leave it unset
                 int colour = m_image->getPixelColour(x, y);
-                pixelMap[y][x] = colour != maskColour;
+                if (colour != maskColour)
+                    pixelMap.set(x, y);
             }
         }
+        pixelMap.buildLevels();
 
         // Return the pointer to the pixel map
         return pixelMap;
@@ -0,0 +1,323 @@
+//
+// Created by Chris Greer on 09/05/2024.
+//
+
+#ifndef G52CPP_PIXELMASK_H
+#define G52CPP_PIXELMASK_H
+
+#include "../../header.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+//Use the widest vector instructions we're being compiled for when checking for overlap
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define G52CPP_PIXELMASK_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+//Which pixels of an image are drawn, packed 64 to a word
+//Each row starts on a new word (stride words per row) and all the rows are in one block of memory
+//Also keeps the tight box around the drawn pixels so overlap tests can skip the empty edges
+//Can also have coarser levels (whether anything is drawn in each 32x32 then 8x8 block) for skipping empty areas
+class PixelMask {
+
+public:
+    PixelMask() = default;
+    PixelMask(int width, int height) { reset(width, height); }
+
+    //Clear to the given size, nothing drawn (re-uses the memory if it's big enough)
+    void reset(int width, int height){
+        m_width = width;
+        m_height = height;
+        m_stride = (width + 63) / 64;
+        m_words.assign(m_stride * height, 0);
+        m_minX = m_width;
+        m_minY = m_height;
+        m_maxX = -1;
+        m_maxY = -1;
+        m_levels.clear();
+    }
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    //Tight box around the drawn pixels (inclusive), min is greater than max if nothing is drawn
+    int getMinX() const { return m_minX; }
+    int getMinY() const { return m_minY; }
+    int getMaxX() const { return m_maxX; }
+    int getMaxY() const { return m_maxY; }
+    bool isEmpty() const { return m_maxX < m_minX; }
+
+    bool get(int x, int y) const {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) return false;
+        return (m_words[y * m_stride + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    //Mark a pixel as drawn, growing the bounding box to fit
+    void set(int x, int y){
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) return;
+        m_levels.clear(); //Changing the mask means the levels would be out of date
+        m_words[y * m_stride + (x >> 6)] |= uint64_t(1) << (x & 63);
+        m_minX = min(m_minX, x);
+        m_minY = min(m_minY, y);
+        m_maxX = max(m_maxX, x);
+        m_maxY = max(m_maxY, y);
+    }
+
+    //Mark a whole rectangle as drawn
+    void fillRect(int x, int y, int width, int height){
+        clip(x, y, width, height);
+        if (width == 0 || height == 0) return;
+        m_levels.clear();
+        for (int row = y; row < y + height; ++row) {
+            for (int word = x >> 6; word <= (x + width - 1) >> 6; ++word) {
+                uint64_t bits = spanBits(word, x, x + width);
+                m_words[row * m_stride + word] |= bits;
+                grow(word, row, bits);
+            }
+        }
+    }
+
+    //Copy the drawn pixels of a rectangle from another mask (starting at sourceX, sourceY) into ours at (x, y)
+    //Goes a word at a time, anything outside either mask is ignored
+    void copyFrom(const PixelMask& source, int sourceX, int sourceY, int x, int y, int width, int height){
+        int clippedX = x;
+        int clippedY = y;
+        clip(clippedX, clippedY, width, height);
+        if (width == 0 || height == 0) return;
+        m_levels.clear();
+        sourceX += clippedX - x;
+        sourceY += clippedY - y;
+        for (int row = 0; row < height; ++row) {
+            int fromRow = sourceY + row;
+            if (fromRow < 0 || fromRow >= source.m_height) continue;
+            const uint64_t* sourceRow = &source.m_words[fromRow * source.m_stride];
+            int toRow = clippedY + row;
+            for (int word = clippedX >> 6; word <= (clippedX + width - 1) >> 6; ++word) {
+                uint64_t bits = source.bitsFrom(sourceRow, sourceX + word * 64 - clippedX)
+                                & spanBits(word, clippedX, clippedX + width);
+                m_words[toRow * m_stride + word] |= bits;
+                grow(word, toRow, bits);
+            }
+        }
+    }
+
+    //Work out the coarser levels, should be done once the mask is finished (any changes after throw them away)
+    void buildLevels(){
+        m_levels.clear();
+        for (int cellSize : m_levelSizes) {
+            Level level;
+            level.cellSize = cellSize;
+            level.width = (m_width + cellSize - 1) / cellSize;
+            level.height = (m_height + cellSize - 1) / cellSize;
+            level.occupied.assign(level.width * level.height, false);
+            for (int y = m_minY; y <= m_maxY; ++y) {
+                for (int x = m_minX; x <= m_maxX; ++x) {
+                    if (get(x, y)) level.occupied[x / cellSize + (y / cellSize) * level.width] = true;
+                }
+            }
+            m_levels.push_back(std::move(level));
+        }
+    }
+    bool hasLevels() const { return !m_levels.empty(); }
+
+    //Whether any drawn pixel of ours lands on a drawn pixel of the other mask
+    //when the other's top left corner is at (offsetX, offsetY) in our coordinates
+    //If both have levels, only goes down into blocks where both have something drawn,
+    //then works a word (64 pixels) at a time, the other mask's rows are shifted to line up with ours
+    bool overlaps(const PixelMask& other, int offsetX, int offsetY) const {
+        if (isEmpty() || other.isEmpty()) return false;
+
+        //Only the area inside both bounding boxes can overlap
+        int left = max(m_minX, other.m_minX + offsetX);
+        int right = min(m_maxX, other.m_maxX + offsetX);
+        int top = max(m_minY, other.m_minY + offsetY);
+        int bottom = min(m_maxY, other.m_maxY + offsetY);
+        if (left > right || top > bottom) return false;
+
+        if (hasLevels() && other.hasLevels())
+            return overlapsLevel(other, offsetX, offsetY, 0, left, top, right, bottom);
+        return overlapsArea(other, offsetX, offsetY, left, top, right, bottom);
+    }
+
+    //Same as overlaps with no offset, for two masks of the same size (quicker, rows line up so no shifting)
+    //Only the rows inside both bounding boxes are checked, as one block of words
+    bool overlapsSameSize(const PixelMask& other) const {
+        if (m_width != other.m_width || m_height != other.m_height) return overlaps(other, 0, 0);
+        int top = max(m_minY, other.m_minY);
+        int bottom = min(m_maxY, other.m_maxY);
+        if (isEmpty() || other.isEmpty() || top > bottom) return false;
+
+        const uint64_t* words = &m_words[top * m_stride];
+        const uint64_t* otherWords = &other.m_words[top * m_stride];
+        size_t count = static_cast<size_t>(bottom - top + 1) * m_stride;
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 4 <= count; i += 4) {
+            __m256i both = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i)),
+                                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(otherWords + i)));
+            if (!_mm256_testz_si256(both, both)) return true;
+        }
+#elif defined(G52CPP_PIXELMASK_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 2 <= count; i += 2) {
+            __m128i both = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(otherWords + i)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(both, zero)) != 0xFFFF) return true;
+        }
+#endif
+        //Whatever's left over (or everything without vector instructions)
+        for (; i < count; ++i) {
+            if (words[i] & otherWords[i]) return true;
+        }
+        return false;
+    }
+
+private:
+    struct Level {
+        int cellSize = 0;
+        int width = 0;
+        int height = 0;
+        vector<bool> occupied; //Whether anything is drawn in each cell
+        //Whether anything is drawn in the cells covering these pixels (inclusive, can be off the edges)
+        bool anyIn(int left, int top, int right, int bottom) const {
+            int firstX = max(floorDiv(left, cellSize), 0);
+            int firstY = max(floorDiv(top, cellSize), 0);
+            int lastX = min(floorDiv(right, cellSize), width - 1);
+            int lastY = min(floorDiv(bottom, cellSize), height - 1);
+            for (int y = firstY; y <= lastY; ++y) {
+                for (int x = firstX; x <= lastX; ++x) {
+                    if (occupied[x + y * width]) return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    //Go through the cells of this level in the area (our coordinates, inclusive)
+    //and only go down to the next one where both of us have something drawn
+    bool overlapsLevel(const PixelMask& other, int offsetX, int offsetY, size_t levelIndex,
+                       int left, int top, int right, int bottom) const {
+        if (levelIndex == m_levels.size())
+            return overlapsArea(other, offsetX, offsetY, left, top, right, bottom);
+
+        const Level& level = m_levels[levelIndex];
+        const Level& otherLevel = other.m_levels[levelIndex];
+        int cellSize = level.cellSize;
+        for (int cellY = top / cellSize; cellY <= bottom / cellSize; ++cellY) {
+            for (int cellX = left / cellSize; cellX <= right / cellSize; ++cellX) {
+                if (!level.occupied[cellX + cellY * level.width]) continue;
+
+                //Part of this cell that's in the area, and whether the other has anything there
+                int cellLeft = max(left, cellX * cellSize);
+                int cellTop = max(top, cellY * cellSize);
+                int cellRight = min(right, cellX * cellSize + cellSize - 1);
+                int cellBottom = min(bottom, cellY * cellSize + cellSize - 1);
+                if (!otherLevel.anyIn(cellLeft - offsetX, cellTop - offsetY, cellRight - offsetX, cellBottom - offsetY))
+                    continue;
+
+                if (overlapsLevel(other, offsetX, offsetY, levelIndex + 1, cellLeft, cellTop, cellRight, cellBottom))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    //Word by word check over an area (our coordinates, inclusive)
+    bool overlapsArea(const PixelMask& other, int offsetX, int offsetY, int left, int top, int right, int bottom) const {
+        int firstWord = left >> 6;
+        int lastWord = right >> 6;
+        for (int y = top; y <= bottom; ++y) {
+            const uint64_t* row = &m_words[y * m_stride];
+            const uint64_t* otherRow = &other.m_words[(y - offsetY) * other.m_stride];
+            for (int word = firstWord; word <= lastWord; ++word) {
+                uint64_t bits = row[word] & other.bitsFrom(otherRow, word * 64 - offsetX);
+                if (bits) return true;
+            }
+        }
+        return false;
+    }
+
+    static int floorDiv(int value, int divisor){
+        return value >= 0 ? value / divisor : -((divisor - 1 - value) / divisor);
+    }
+
+    //Shrinks a rectangle to the part inside the mask (width/height end up 0 or less if none of it is)
+    void clip(int& x, int& y, int& width, int& height) const {
+        int right = min(x + width, m_width);
+        int bottom = min(y + height, m_height);
+        x = max(x, 0);
+        y = max(y, 0);
+        width = max(right - x, 0);
+        height = max(bottom - y, 0);
+    }
+
+    //Bits of this word that are between fromX and toX (not including toX)
+    static uint64_t spanBits(int word, int fromX, int toX){
+        int start = max(fromX - word * 64, 0);
+        int end = min(toX - word * 64, 64);
+        if (start >= end) return 0;
+        uint64_t bits = end == 64 ? ~uint64_t(0) : (uint64_t(1) << end) - 1;
+        return bits & ~((uint64_t(1) << start) - 1);
+    }
+
+    //Grow the bounding box to fit any bits set in this word
+    void grow(int word, int row, uint64_t bits){
+        if (!bits) return;
+        m_minX = min(m_minX, word * 64 + lowestBit(bits));
+        m_maxX = max(m_maxX, word * 64 + highestBit(bits));
+        m_minY = min(m_minY, row);
+        m_maxY = max(m_maxY, row);
+    }
+
+    static int lowestBit(uint64_t bits){
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+    static int highestBit(uint64_t bits){
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, bits);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(bits);
+#endif
+    }
+
+
+    //The 64 pixels of a row starting at pixel x (can start part way through a word or off either end)
+    uint64_t bitsFrom(const uint64_t* row, int x) const {
+        int word = x >= 0 ? x / 64 : -((63 - x) / 64); //Round down for negatives too
+        int shift = x - word * 64;
+        uint64_t low = (word >= 0 && word < m_stride) ? row[word] : 0;
+        if (shift == 0) return low;
+        uint64_t high = (word + 1 >= 0 && word + 1 < m_stride) ? row[word + 1] : 0;
+        return (low >> shift) | (high << (64 - shift));
+    }
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    int m_stride = 0; //Words per row
+    vector<uint64_t> m_words;
+    int m_minX = 0;
+    int m_minY = 0;
+    int m_maxX = -1;
+    int m_maxY = -1;
+    //Coarser levels, biggest cells first (empty if they haven't been built)
+    inline static const int m_levelSizes[] = {32, 8};
+    vector<Level> m_levels;
+};
+
+#endif //G52CPP_PIXELMASK_H
@@ -13,6 +13,8 @@
 #include "../ZUtility/MathUtil.h"
 #include "../ZObjects/ZEnemy.h"
 #include "../ZUtility/TileCodes.h"
+#include "../ZMaps/VisibilityMap.h"
+#include "../ZUtility/Metrics.h"
 
 //Class to handle the ray tracing logic in the game
 //Includes the line of sight of the player (towards any enemies/obstacles)
@@ -20,15 +22,17 @@
 class RayTrace {
 
 public:
-
-    static void playerLineOfSight(GameObject *player, ZEngine* pEngine, int xOffset, int yOffset ){
+    //Works out what the player is aiming at (tells the engine) and where the laser goes
+    //Done when updating rather than drawing so it still happens without a display (headless)
+    static void playerLineOfSight(GameObject *player, ZEngine* pEngine, int xOffset, int yOffset, LaserLine& laser){
 
         //First declare that player is not going to hit anything yet
         //Will get set (again) IF an enemy is in the firing range.
         pEngine->setInSights({nullptr,0});
+        laser.shown = false;
 
-        auto mouseX = static_cast<float>(pEngine->getCurrentMouseX());
-        auto mouseY = static_cast<float>(pEngine->getCurrentMouseY());
+        auto mouseX = static_cast<float>(pEngine->getGameMouseX());
+        auto mouseY = static_cast<float>(pEngine->getGameMouseY());
 
         auto objX = static_cast<float>(player->getExactRealCenterX());
         auto objY = static_cast<float>(player->getExactRealCenterY());
@@ -69,15 +73,24 @@ public:
         float length = playerLosLength(pEngine, offsetX, offsetY, radAngle);
 
         //Work out where our line goes to
-        float lineX = length * cos(radAngle);
-        float lineY = length * sin(radAngle);
+        laser = {offsetX, offsetY, offsetX + length * cos(radAngle), offsetY + length * sin(radAngle), true};
+    }
 
-        pEngine->getForegroundSurface()->drawLine(offsetX, offsetY,
-                                                  (offsetX + lineX), (offsetY + lineY),
+    //Draws the laser worked out by playerLineOfSight (if there is one)
+    static void drawLaser(ZEngine* pEngine, const LaserLine& laser){
+        if (!laser.shown) return;
+        pEngine->getForegroundSurface()->drawLine(laser.fromX, laser.fromY,
+                                                  laser.toX, laser.toY,
                                                   0x30D5C8);
+        //Box around the line so the background can be put back
+        int left = static_cast<int>(min(laser.fromX, laser.toX));
+        int top = static_cast<int>(min(laser.fromY, laser.toY));
+        pEngine->getDirtyRegions().drawnOver(left - 1, top - 1, static_cast<int>(fabs(laser.toX - laser.fromX)) + 3,
+                                             static_cast<int>(fabs(laser.toY - laser.fromY)) + 3);
     }
 
     static float playerLosLength(ZEngine* pEngine, float pointX, float pointY, float angle){
+        METRICS_TIME(t_playerLos);
 
         float directionX = cos(angle);
         float directionY = sin(angle);
@@ -85,6 +98,11 @@ public:
         float stepSize = 7;
         float length = 0;
         MapTileManager* collisionMap = pEngine->getCollisionMap().get();
+        MapOffsetFilter* mapFilter = pEngine->getMapFilter().get();
+        //Only the enemies in the laser's cell need checking, re-collected each time it moves into a new cell
+        SpatialGrid<ZEnemy>& enemyGrid = pEngine->getEnemyGrid();
+        vector<ZEnemy*> nearbyEnemies;
+        int currentCell = -1;
 
         //Move along the line and return length once you hit an obstacle OR reach the edge
         while(true){
@@ -95,14 +113,15 @@ public:
             if (xVal < 0 || yVal < 0 || xVal > pEngine->getWindowWidth() || yVal > pEngine->getWindowHeight())
                 return length; //We've hit the edge
 
-            //Check for each non-player object (will have to change once non-living objects exist)
-            //Actually range will be correct... Still check
-            int i = 1;
-            while(true){
-                DisplayableObject* object = pEngine->getDisplayableObject(i++);
-                if (!object)  break; //Have reached the end of the array.
-                auto* enemy = dynamic_cast<ZEnemy *>(object);
-                if (!enemy) continue ;//If dynamic cast didn't work
+            //Check the enemies around this point (grid is in real locations)
+            int realX = mapFilter->filterConvertVirtualToRealXPosition(xVal);
+            int realY = mapFilter->filterConvertVirtualToRealYPosition(yVal);
+            int cell = enemyGrid.cellIndex(realX, realY);
+            if (cell != currentCell) {
+                currentCell = cell;
+                enemyGrid.collectAt(realX, realY, nearbyEnemies);
+            }
+            for (ZEnemy* enemy : nearbyEnemies) {
 
                 //Check if Object is visable, on screen and alive
                 if (!enemy->isVisible() || enemy->isDead() || !enemy->isInScreen())
@@ -143,40 +162,20 @@ public:
     //This is used to determine line of sight along a shortest path to check whether
     //It's necessary to keep iterating through the path or if you can just go directly towards player at that point
     static bool lineOfSightToPlayer(ZEngine* pEngine, int fromX, int fromY){
+        METRICS_TIME(t_losToPlayer);
+
+        //Usually already worked out for every tile this tick (from the player's tile), so just look it up
+        VisibilityMap* visibilityMap = pEngine->getVisibilityMap();
+        if (visibilityMap && visibilityMap->isUpToDate())
+            return visibilityMap->canSeePlayer(fromX, fromY);
 
         int playerX = pEngine->getPlayerCoords().x;
         int playerY = pEngine->getPlayerCoords().y;
 
-        int targetDistance = MathUtil::distanceBetween(fromX, fromY, playerX, playerY);
-
-        //Get the angle between them
-        auto radAngle = static_cast<float>(DrawingSurface::getAngle(
-                fromX, fromY,
-                playerX, playerY));
-
-        //Split directions into x and y parts
-        float directionX = cos(radAngle);
-        float directionY = sin(radAngle);
-
-        //Can use a much larger step size since we only care about the tiles we pass over
-        //(not whether we hit the exact first point of the player closest)
-        int stepSize = 44;
-        int length = 0;
-
-        MapTileManager* collisionMap = pEngine->getCollisionMap().get();
-        //Move along the line and return true if we can reach the player without hitting an obstacle
-        while(length < targetDistance) {
-            length += stepSize;
-            int xVal = fromX + static_cast<int>(directionX * static_cast<float>(length));
-            int yVal = fromY + static_cast<int>(directionY * static_cast<float>(length));
-
-            //Check if direct path to player crosses any obstacle tiles
-            int mapValue = collisionMap->getMapValueForScreenLocation(xVal, yVal, true);
-            if (TileCodes::isLosBlockingTile(mapValue)) return false;
-            //Don't need to check if specific pixel is filled at that location
-        }
-        //If gone all the way to the player without obstacle, then have line of sight
-        return true;
+        //We only care about the tiles we pass over (not whether we hit the exact first point of the player closest)
+        //So walk each tile between us and the player once, using the precomputed blocking flags
+        //Don't need to check if specific pixel is filled at that location
+        return pEngine->getCollisionMap()->lineOfSight(fromX, fromY, playerX, playerY);
     }
 
 
@@ -0,0 +1,94 @@
+//
+// Created by Chris Greer on 10/05/2024.
+//
+
+#ifndef G52CPP_ROTATEDPIXELMAPS_H
+#define G52CPP_ROTATEDPIXELMAPS_H
+
+#include "../../header.h"
+#include "../../SimpleImage.h"
+#include "../../ImagePixelMapping.h"
+#include "PixelMapCreator.h"
+#include <map>
+#include <tuple>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+//Copies of the pixel maps already rotated to a set number of angles (so the rotation is rounded to the nearest one)
+//Collision checks can then just look up a bit rather than rotating every pixel they check
+//Each angle is only built the first time it's asked for, after that it's kept
+class RotatedPixelMaps {
+
+public:
+    //More steps is more accurate but uses more memory (up to one copy of the pixel map per step)
+    //Setting 0 turns it off and everything goes back to rotating each pixel
+    void setSteps(int steps){
+        m_steps = max(0, steps);
+        clear();
+    }
+    int getSteps() const { return m_steps; }
+
+    void clear(){
+        m_rotated.clear();
+        m_generation++;
+    }
+    //Goes up every time the rotated maps are thrown away, so anything holding on to one knows to look it up again
+    unsigned int getGeneration() const { return m_generation; }
+
+    //The pixel map rotated around (centreX, centreY) by roughly this much, same size as the original
+    //Null if turned off (or there's no pixel map)
+    const PixelMask* getRotated(const PixelMap* pixelMap, const SimpleImage& image,
+                                int centreX, int centreY, double rotation){
+        if (m_steps == 0 || pixelMap == nullptr) return nullptr;
+
+        //Round to the nearest step (rotation can be any number of turns either way)
+        double turns = rotation / (2 * M_PI);
+        turns -= floor(turns);
+        int step = static_cast<int>(lround(turns * m_steps)) % m_steps;
+
+        //Same pixel map can be rotated around different centres so need both in the key
+        vector<Rotated>& angles = m_rotated[make_tuple(pixelMap, centreX, centreY)];
+        if (angles.empty()) angles.resize(m_steps);
+        Rotated& rotated = angles[step];
+        if (!rotated.built) {
+            build(rotated.mask, *pixelMap, image, centreX, centreY, step * 2 * M_PI / m_steps);
+            rotated.built = true;
+        }
+        return &rotated.mask;
+    }
+
+    //Uses the same mapping as drawing does, so a pixel is set if it's drawn at that rotation
+    //(Also used by objects to rotate exactly when pre-rotating is turned off)
+    static void build(PixelMask& rotated, const PixelMap& pixelMap, const SimpleImage& image,
+                      int centreX, int centreY, double rotation){
+        ImagePixelMappingRotateAndColour mapping;
+        mapping.setRotationCentre(centreX, centreY);
+        mapping.setRotation(rotation);
+
+        rotated.reset(pixelMap.getWidth(), pixelMap.getHeight());
+        for (int y = 0; y < pixelMap.getHeight(); ++y) {
+            for (int x = 0; x < pixelMap.getWidth(); ++x) {
+                double pixelX = x;
+                double pixelY = y;
+                mapping.mapCoordinates(pixelX, pixelY, image);
+                if (pixelMap.get(static_cast<int>(pixelX), static_cast<int>(pixelY)))
+                    rotated.set(x, y);
+            }
+        }
+        rotated.buildLevels();
+    }
+
+private:
+    struct Rotated {
+        bool built = false;
+        PixelMask mask;
+    };
+
+    int m_steps = 64;
+    unsigned int m_generation = 0;
+    map<tuple<const PixelMap*, int, int>, vector<Rotated>> m_rotated;
+};
+
+#endif //G52CPP_ROTATEDPIXELMAPS_H
@@ -0,0 +1,184 @@
+//
+// Created by Chris Greer on 18/05/2024.
+//
+
+#ifndef G52CPP_SPRITECACHE_H
+#define G52CPP_SPRITECACHE_H
+
+#include "../../header.h"
+#include "../../DrawingSurface.h"
+#include "../../SimpleImage.h"
+#include "../../ImagePixelMapping.h"
+#include <map>
+#include <list>
+#include <tuple>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+//Images already rotated (to a set number of angles, like RotatedPixelMaps) and masked, cropped down to just
+//the pixels that get drawn. Drawing one is then just copying runs of pixels rather than rotating every pixel
+//Each one is only made the first time it's drawn, and the least recently drawn are thrown away once they take
+//up more than the memory budget
+class SpriteCache {
+
+public:
+    //A run of drawn pixels along one row
+    struct Run {
+        int x, y; //From the sprite's top left
+        int length;
+        int start; //First colour in m_colours
+    };
+    //One rotated image, location is relative to where the whole (unrotated) image would be drawn
+    struct Sprite {
+        int left = 0, top = 0, width = 0, height = 0;
+        vector<Run> runs;
+        vector<unsigned int> colours;
+
+        size_t bytes() const { return sizeof(Sprite) + runs.size() * sizeof(Run) + colours.size() * sizeof(unsigned int); }
+
+        //Top left of the whole image at this location (same as renderImageApplyingMapping), clipped to the surface
+        void draw(DrawingSurface* target, int drawX, int drawY) const {
+            int surfaceWidth = target->getSurfaceWidth();
+            int surfaceHeight = target->getSurfaceHeight();
+            for (const Run& run : runs) {
+                int y = drawY + top + run.y;
+                if (y < 0 || y >= surfaceHeight) continue;
+                int runX = drawX + left + run.x;
+                int from = max(runX, 0);
+                int to = min(runX + run.length, surfaceWidth);
+                for (int x = from; x < to; ++x) target->rawSetPixel(x, y, colours[run.start + x - runX]);
+            }
+        }
+    };
+
+    //Should match RotatedPixelMaps so what's drawn is what collides, 0 turns it off (back to rotating every draw)
+    void setSteps(int steps){
+        m_steps = max(0, steps);
+        clear();
+    }
+    //How much memory (roughly) to keep sprites in before throwing the least recently drawn away
+    void setBudget(size_t bytes){
+        m_budget = bytes;
+        evict();
+    }
+    size_t getBytesUsed() const { return m_bytesUsed; }
+
+    void clear(){
+        m_sprites.clear();
+        m_recent.clear();
+        m_bytesUsed = 0;
+    }
+
+    //The image rotated around (centreX, centreY) by roughly this much, masking out the transparency colour
+    //Null if turned off
+    const Sprite* get(const SimpleImage* image, int centreX, int centreY, double rotation, unsigned int transparency = 0){
+        if (m_steps == 0 || image == nullptr) return nullptr;
+
+        //Round to the nearest step (rotation can be any number of turns either way)
+        double turns = rotation / (2 * M_PI);
+        turns -= floor(turns);
+        int step = static_cast<int>(lround(turns * m_steps)) % m_steps;
+
+        Key key = make_tuple(image, centreX, centreY, step, transparency);
+        auto found = m_sprites.find(key);
+        if (found != m_sprites.end()) {
+            //Most recently drawn goes to the front
+            m_recent.splice(m_recent.begin(), m_recent, found->second.recent);
+            return &found->second.sprite;
+        }
+
+        Entry& entry = m_sprites[key];
+        build(entry.sprite, *image, centreX, centreY, step * 2 * M_PI / m_steps, transparency);
+        m_recent.push_front(key);
+        entry.recent = m_recent.begin();
+        m_bytesUsed += entry.sprite.bytes();
+        evict(&entry);
+        return &entry.sprite;
+    }
+
+private:
+    using Key = tuple<const SimpleImage*, int, int, int, unsigned int>;
+    struct Entry {
+        Sprite sprite;
+        list<Key>::iterator recent;
+    };
+
+    //Uses the same mapping as drawing did, so a pixel is drawn if it would have been at that rotation
+    static void build(Sprite& sprite, const SimpleImage& image, int centreX, int centreY, double rotation,
+                      unsigned int transparency){
+        ImagePixelMappingRotateAndColour mapping;
+        mapping.setTransparencyColour(static_cast<int>(transparency));
+        mapping.setRotationCentre(centreX, centreY);
+        mapping.setRotation(rotation);
+
+        //Work out every pixel first, then crop down to the ones that are drawn
+        int width = image.getWidth();
+        int height = image.getHeight();
+        vector<unsigned int> colours(static_cast<size_t>(width) * height);
+        vector<bool> drawn(colours.size(), false);
+        int left = width, top = height, right = -1, bottom = -1;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                double pixelX = x;
+                double pixelY = y;
+                if (!mapping.mapCoordinates(pixelX, pixelY, image)) continue;
+                auto imageX = static_cast<int>(pixelX);
+                auto imageY = static_cast<int>(pixelY);
+                if (imageX < 0 || imageY < 0 || imageX >= width || imageY >= height) continue;
+                auto colour = static_cast<unsigned int>(image.getPixelColour(imageX, imageY));
+                if (colour == transparency) continue;
+                colours[x + y * width] = colour;
+                drawn[x + y * width] = true;
+                left = min(left, x);
+                top = min(top, y);
+                right = max(right, x);
+                bottom = max(bottom, y);
+            }
+        }
+
+        sprite = Sprite();
+        if (right < 0) return; //Nothing drawn at all
+        sprite.left = left;
+        sprite.top = top;
+        sprite.width = right - left + 1;
+        sprite.height = bottom - top + 1;
+        for (int y = top; y <= bottom; ++y) {
+            int x = left;
+            while (x <= right) {
+                if (!drawn[x + y * width]) { ++x; continue; }
+                Run run{x - left, y - top, 0, static_cast<int>(sprite.colours.size())};
+                while (x <= right && drawn[x + y * width]) {
+                    sprite.colours.push_back(colours[x + y * width]);
+                    ++run.length;
+                    ++x;
+                }
+                sprite.runs.push_back(run);
+            }
+        }
+        sprite.runs.shrink_to_fit();
+        sprite.colours.shrink_to_fit();
+    }
+
+    //Throws away the least recently drawn until back under budget (never the one just made)
+    void evict(const Entry* keep = nullptr){
+        while (m_bytesUsed > m_budget && !m_recent.empty()) {
+            auto oldest = m_sprites.find(m_recent.back());
+            if (&oldest->second == keep) break;
+            m_bytesUsed -= oldest->second.sprite.bytes();
+            m_sprites.erase(oldest);
+            m_recent.pop_back();
+        }
+    }
+
+private:
+    int m_steps = 64;
+    size_t m_budget = 32 * 1024 * 1024;
+    size_t m_bytesUsed = 0;
+    map<Key, Entry> m_sprites;
+    list<Key> m_recent; //Most recently drawn first
+};
+
+#endif //G52CPP_SPRITECACHE_H
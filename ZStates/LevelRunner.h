@@ -36,7 +36,7 @@ public:
        if (fromSave)
            intialiseTiles(); //If from save then initialise them based on the save data
 
-       //Create our AStar Map based on these surfaces/Tiles
+       //Create our AStar Map based on these surfaces/Tiles (works out the clusters up front)
        pEngine->setAStar(m_collisionMap.get());
 
     }
@@ -46,7 +46,8 @@ public:
         for (auto& keyTile : m_keyTiles) {
             if (keyTile.triggered) {
                 //Redraw this tile to show it was triggered already
-                m_collisionMap->setAndRedrawMapValueAt(keyTile.x, keyTile.y, TileCodes::inactiveKey(), m_pEngine , m_srcSurface.get());
+                m_collisionMap->setMapValue(keyTile.x, keyTile.y, TileCodes::inactiveKey());
+                tileChanged(keyTile.x, keyTile.y);
                 if (keyTile.type == 'K') { //if this is a main key then more logic to check/update
                     m_keysActivated++; //Update key count
                     if (m_keysActivated == m_pEngine->getTotalKeys()){
@@ -55,7 +56,8 @@ public:
                 }
                 //If normal unlock or have got all the main keys, unlock the relevant tiles based on this tile
                 for (const auto& unlockTile : keyTile.unlocksTiles) {
-                    m_collisionMap->setAndRedrawMapValueAt(unlockTile.x, unlockTile.y, unlockTile.newMap, m_pEngine, m_srcSurface.get());
+                    m_collisionMap->setMapValue(unlockTile.x, unlockTile.y, unlockTile.newMap);
+                    tileChanged(unlockTile.x, unlockTile.y);
                 }
             }
         }
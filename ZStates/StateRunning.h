@@ -51,7 +51,8 @@ public:
         for (auto& keyTile : m_keyTiles) {
             if (!keyTile.triggered && keyTile.x == tileX && keyTile.y == tileY) {
                 //Redraw this tile to show it was triggered already
-                m_collisionMap->setAndRedrawMapValueAt(tileX, tileY, TileCodes::inactiveKey(), m_pEngine , m_srcSurface.get());
+                m_collisionMap->setMapValue(tileX, tileY, TileCodes::inactiveKey());
+                tileChanged(tileX, tileY);
                 keyTile.triggered = true; //Update that it's been triggered (uneccessary but allows extension)
 
                 if (keyTile.type == 'K') { //if this is a main key then more logic to check/update
@@ -62,20 +63,21 @@ public:
                 }
                 //If normal unlock or have got all the main keys, unlock the relevant tiles based on this tile
                 for (const auto& unlockTile : keyTile.unlocksTiles) {
-                    m_collisionMap->setAndRedrawMapValueAt(unlockTile.x, unlockTile.y, unlockTile.newMap, m_pEngine, m_srcSurface.get());
+                    m_collisionMap->setMapValue(unlockTile.x, unlockTile.y, unlockTile.newMap);
+                    tileChanged(unlockTile.x, unlockTile.y);
                     normalUnlock = true; //We've unlocked some doors
                 }
                 if (normalUnlock) {
                     //Need engine to update the AStar algo to account for change in tiles...
-                    m_pEngine->setAStar(m_collisionMap.get());
+                    m_pEngine->setAStar(m_collisionMap.get(), keyTile.unlocksTiles);
                 }
                 m_pEngine->setKeyTiles(m_keyTiles); //Update the engine, (should really be done with pointers)
                 break; //Don't need to check any further
             }
         }
 
-        //Auto-Save the game at this point
-        SaveLoadUtil::saveGame(m_pEngine,0,"AutoSave");
+        //Auto-Save the game at this point (not from a headless run, don't want to overwrite the player's)
+        if (!m_pEngine->isHeadless()) SaveLoadUtil::saveGame(m_pEngine,0,"AutoSave");
     }
 
     void setUpBackgroundBuffer() override{} //Don't actually need to set anything in background buffer
@@ -88,50 +90,64 @@ public:
         MapOffsetFilter* mapFilter = m_mapFilter.get();
         int offsetX = mapFilter->getXOffset();
         int offsetY = mapFilter->getYOffset();
+        DirtyRegions& dirtyRegions = m_pEngine->getDirtyRegions();
 
         //Update our waves animation background
-        Animator::animate(m_waveSurface, 
-            m_backgroundWaves, m_pEngine->getModifiedTime(), m_wavesCounter, m_wavesLastUpdated, 80);
-        m_pEngine->getForegroundSurface()->copyEntireSurface(m_waveSurface.get());
-
-        //IF updated, are we doing this too frequently otherwise??
-        //Although it is constantly updated...
-        //Draw the shifted background to show the movement
-        m_pEngine->getForegroundSurface()->copyRectangleFrom(m_srcSurface.get(),
-                                                  0,0,
-                                                  m_pEngine->getWindowWidth(),m_pEngine->getWindowHeight(),
-                                                  offsetX, offsetY);
-        //Do the same from our effects surface
-        m_pEngine->getForegroundSurface()->copyRectangleFrom(m_effectsSurface.get(),
-                                                  0,0,
-                                                  m_pEngine->getWindowWidth(),m_pEngine->getWindowHeight(),
-                                                  offsetX, offsetY);
+        bool wavesMoved = m_waves->setTime(m_pEngine->getGameTime());
+
+        //Map has scrolled, the whole screen is different
+        //Can't just shift what's already there since the screen can't be copied onto itself
+        if (offsetX != m_lastOffsetX || offsetY != m_lastOffsetY) {
+            dirtyRegions.invalidateAll();
+        } else if (wavesMoved) {
+            //Only where the waves can be seen
+            m_waves->exposedAreas(m_world.get(), {0, 0, m_pEngine->getWindowWidth(), m_pEngine->getWindowHeight()},
+                                  offsetX, offsetY, m_exposed);
+            for (const auto& area : m_exposed) dirtyRegions.changed(area.left, area.top, area.width(), area.height());
+        }
+        m_lastOffsetX = offsetX;
+        m_lastOffsetY = offsetY;
+
+        //Only copy the parts that need it (where things were drawn last frame, or have changed)
+        dirtyRegions.beginFrame(m_regions);
+        for (const auto& region : m_regions) copyBackground(region, offsetX, offsetY);
+        //Get a page just off screen ready, so it doesn't have to be drawn all at once when it scrolls on
+        m_world->prefetch(offsetX, offsetY, m_pEngine->getWindowWidth(), m_pEngine->getWindowHeight(),
+                          m_pEngine->getTileSize() * 4);
     }
     void postDraw() override{
 
         //Draw our hud on top of everything (inc objects)
-        m_pEngine->getForegroundSurface()->
-        copyRectangleFrom(m_hudSurface.get(),0,700,
-                           m_pEngine->getWindowWidth(),100,
-                           0,0);
-        //Now draw on top of that our actual values
-        drawHudInfo(m_pEngine,m_pEngine->getForegroundSurface());
+        //Only if something has been copied/drawn over it or the values have changed, otherwise it's still there
+        ZPlayer* player = m_pEngine->getPlayer();
+        HudValues hudValues{player->getHealth(), player->getArmour(), player->getAmmo(), player->getWeapon()};
+        DirtyRegions::Rect hudArea{0, 700, m_pEngine->getWindowWidth(), 800};
+        if (hudValues != m_hudValues || m_pEngine->getDirtyRegions().touchedThisFrame(hudArea)) {
+            m_pEngine->getForegroundSurface()->
+            copyRectangleFrom(m_hudSurface.get(),0,700,
+                               m_pEngine->getWindowWidth(),100,
+                               0,0);
+            //Now draw on top of that our actual values
+            drawHudInfo(m_pEngine,m_pEngine->getForegroundSurface());
+            m_hudValues = hudValues;
+        }
 
         if (m_pEngine->isKeyPressed(SDLK_m)){
             shared_ptr<SimpleImage> image = (*ImagePixelRepo::getSingleImages()).at(m_pEngine->getLevelNumber());
             image->renderImage(m_pEngine->getForegroundSurface(),0,0,300,139,image->getWidth(),image->getHeight());
+            m_pEngine->getDirtyRegions().drawnOver(0, 0, 300, 139);
         }
     }
 
     void beforeUpdate() override {
         if (!m_pEngine->getPlayer() || !m_pEngine->getMapFilter()) return ;
 
-        int ticks = m_pEngine->getModifiedTime() - m_lastUpdated;
+        int ticks = m_pEngine->getGameTime() - m_lastUpdated;
 
         //If we updated too recently don't need to do anything for this update
         if (ticks < 20) return;
-        else m_lastUpdated = m_pEngine->getModifiedTime();
-        //cout << ticks << endl;
+        else m_lastUpdated = m_pEngine->getGameTime();
+        //Timings for this are in the Metrics overlay (F3) and metrics.csv
 
         //If we're moving at all then do some updating
         if(m_pEngine->updatePlayerMovement()){
@@ -146,6 +162,10 @@ public:
             //Stopped moving so don't animate
             m_pEngine->getPlayer()->setMoving(false);
         }
+        //Enemies all path towards the player using this (only recalculates when needed)
+        m_pEngine->updatePathFinding();
+        //Same for who can see the player
+        m_pEngine->updateVisibility();
     }
 
     void postUpdate() override {
@@ -235,12 +255,43 @@ public:
     }
 
 private:
+    //Waves (just where the map doesn't cover), then the map (blood is already on it), for just this part of the screen
+    void copyBackground(const DirtyRegions::Rect& region, int offsetX, int offsetY){
+        DrawingSurface* foreground = m_pEngine->getForegroundSurface();
+        m_waves->exposedAreas(m_world.get(), region, offsetX, offsetY, m_exposed);
+        for (const auto& area : m_exposed) m_waves->draw(foreground, area);
+        m_world->copyTo(foreground, region.left, region.top, region.width(), region.height(), offsetX, offsetY);
+    }
+
     void updateOffset() {
         m_mapFilter->setOffset(m_pEngine->getPlayerCoords().x - m_pEngine->getPlayer()->getExactRealCenterX(),
             m_pEngine->getPlayerCoords().y - m_pEngine->getPlayer()->getExactRealCenterY());
 
     }
+protected:
+    //Tile's value has changed, redraw it on the map (along with any blood on it) and copy it onto the screen
+    void tileChanged(int tileX, int tileY){
+        int tileSize = m_pEngine->getTileSize();
+        m_world->redrawTile(tileX, tileY);
+        m_pEngine->getDirtyRegions().changed(tileX * tileSize - m_mapFilter->getXOffset(),
+                                             tileY * tileSize - m_mapFilter->getYOffset(),
+                                             tileSize, tileSize);
+    }
+
+private:
     long m_lastUpdated = 0;
+    //What the screen was last drawn with, to know what needs drawing again
+    struct HudValues {
+        int health, armour, ammo, weapon;
+        bool operator!=(const HudValues& other) const {
+            return health != other.health || armour != other.armour || ammo != other.ammo || weapon != other.weapon;
+        }
+    };
+    HudValues m_hudValues{-1, -1, -1, -1};
+    int m_lastOffsetX = 0;
+    int m_lastOffsetY = 0;
+    vector<DirtyRegions::Rect> m_regions; //Being copied this frame
+    vector<DirtyRegions::Rect> m_exposed; //Parts the waves show through, kept to save reallocating
 };
 
 #endif //G52CPP_STATERUNNING_H
@@ -11,6 +11,8 @@
 #include "../ZEngine.h"
 #include "../ZMaps/MapLoader.h"
 #include "../ZMaps/MapTileManager.h"
+#include "../ZMaps/WorldSurface.h"
+#include "../ZMaps/WaveBackground.h"
 #include "../../DrawingSurface.h"
 
 //Responsible for loading and maintaining surfaces, tile managers and offsets
@@ -20,50 +22,42 @@ class SurfaceManager {
 public:
     ~SurfaceManager() {
         m_collisionMap.reset();
-        //m_effectsSurface.reset();
+        m_grassMap.reset();
+        m_floorMap.reset();
         m_mapFilter.reset();
-        m_srcSurface.reset();
+        m_world.reset();
         m_hudSurface.reset();
-        m_waveSurface.reset();
-        for (auto& wave : m_backgroundWaves) { wave.reset(); }
-        m_backgroundWaves.clear();
+        m_waves.reset();
     }
     shared_ptr<MapTileManager> getCollisionMap() const { return m_collisionMap; }
-    DrawingSurface* getEffectsSurface() const { return m_effectsSurface.get(); }
-    DrawingSurface* getSrcSurface() const { return m_srcSurface.get(); }
+    WorldSurface* getWorldSurface() const { return m_world.get(); }
     shared_ptr<MapOffsetFilter> getOffsetFilter() const { return m_mapFilter; }
 
 protected:
     void setUpSurfaces(ZEngine* pEngine){
 
         setUpWavesBackground(pEngine);
-        setUpSourceSurface(pEngine);
+        setUpWorldSurface(pEngine);
         //loadLevelMaps(pEngine, level);
-        setUpEffectsSurface(pEngine);
+        //Blood is stamped straight onto the world surface, no separate effects layer
         initialiseHUD(pEngine);
         m_collisionMap = make_shared<MapTileManager>(pEngine, pEngine->getTileSize(), pEngine->getTileSize());
+        m_grassMap = make_shared<MapTileManager>(pEngine, pEngine->getTileSize(), pEngine->getTileSize());
+        m_floorMap = make_shared<MapTileManager>(pEngine, pEngine->getTileSize(), pEngine->getTileSize());
 
     }
 
     void loadLevelMaps(ZEngine* pEngine, const string& level) {
 
-        //First clear our main surfaces in case we drew on them earlier
-        
-       /* m_effectsSurface->fillSurface(0);
-        m_srcSurface->fillSurface(0);*/
-        m_effectsSurface->setAlpha(0);
-        m_srcSurface->setAlpha(0);
-        
-
-        //Load up our source map layers
+        //Load up our map layers (only the values, the world surface draws them as they come on screen)
         //First layer is just the general background grass etc
-        MapLoader::loadTileMap(pEngine, m_srcSurface.get(),
-            pEngine->getTilesX(), pEngine->getTilesY(),
+        m_grassMap->setMapSize(pEngine->getTilesX(), pEngine->getTilesY());
+        MapLoader::loadTileValues(pEngine, m_grassMap.get(),
             "./resources/TileMaps/" + level + "/GrassTiles.txt");
 
         //Second layer is floors etc
-        MapLoader::loadTileMap(pEngine, m_srcSurface.get(),
-            pEngine->getTilesX(), pEngine->getTilesY(),
+        m_floorMap->setMapSize(pEngine->getTilesX(), pEngine->getTilesY());
+        MapLoader::loadTileValues(pEngine, m_floorMap.get(),
             "./resources/TileMaps/" + level + "/FloorTiles.txt");
 
         //Load our second layer which determines collision
@@ -72,8 +66,11 @@ protected:
         //m_collisionMap = make_shared<MapTileManager>(pEngine, pEngine->getTileSize(), pEngine->getTileSize());
         m_collisionMap->setTopLeftPositionOnScreen(0, 0);
         m_collisionMap->setMapSize(pEngine->getTilesX(), pEngine->getTilesY());
-        MapLoader::loadTileMap(pEngine, m_srcSurface.get(), m_collisionMap.get(),
+        MapLoader::loadTileValues(pEngine, m_collisionMap.get(),
             "./resources/TileMaps/" + level + "/CollisionTiles.txt");
+
+        //Drawn in this order, also forgets any pages (and blood) from a previous level
+        m_world->setLayers({m_grassMap, m_floorMap, m_collisionMap});
     }
 
 
@@ -101,51 +98,21 @@ protected:
 
     }
 
-    void setUpSourceSurface(ZEngine* pEngine) {
-        //Create our larger 'source' background where we will blit from
-        m_srcSurface.reset();
-        m_srcSurface = make_shared<DrawingSurface>(pEngine);
-        m_srcSurface->createSurface(pEngine->getTilesX() * pEngine->getTileSize(),
-            pEngine->getTilesY() * pEngine->getTileSize());
-        m_srcSurface->removeBoundsCheck();
-        //Need to set this to nullptr to avoid having issues drawing 'outside' the screen
-        m_srcSurface->setDrawPointsFilter(nullptr);
+    void setUpWorldSurface(ZEngine* pEngine) {
+        //The map we copy the background from, in pages that are only drawn when near the screen
+        m_world.reset();
+        m_world = make_shared<WorldSurface>(pEngine,
+            pEngine->getTilesX() * pEngine->getTileSize(),
+            pEngine->getTilesY() * pEngine->getTileSize(),
+            pEngine->getTileSize());
     }
 
 
-    void setUpEffectsSurface(ZEngine* pEngine){
-
-        //Create our larger 'effects' background where we will blit effects from
-        m_effectsSurface.reset();
-        m_effectsSurface = make_shared<DrawingSurface>(pEngine);
-        m_effectsSurface->removeBoundsCheck();
-        m_effectsSurface->setDrawPointsFilter(nullptr);
-        m_effectsSurface->createSurface(pEngine->getTilesX() * pEngine->getTileSize(),
-                                        pEngine->getTilesY() * pEngine->getTileSize());
-    }
-
 private:
     void setUpWavesBackground(ZEngine* pEngine){
-        shared_ptr<DrawingSurface> backSource = make_shared<DrawingSurface>(pEngine);
-
-        backSource->setDrawPointsFilter(nullptr);
-        backSource->createSurface(pEngine->getTilesX() * pEngine->getTileSize(),
-                                  pEngine->getTilesY() * pEngine->getTileSize());
-        MapLoader::loadTileMap(pEngine, backSource.get(),
-                             pEngine->getTilesX() * pEngine->getTileSize(),
-                             pEngine->getTilesY() * pEngine->getTileSize(),
-                               "./resources/TileMaps/WavesTiles.txt");
-        //Set our our multiple waves surfaces
-        for (int i = 0; i < 16; ++i) {
-            shared_ptr<DrawingSurface> back = make_shared<DrawingSurface>(pEngine);
-            back->createSurface(pEngine->getWindowWidth(),pEngine->getWindowHeight());
-            back->copyRectangleFrom(backSource.get(),
-                                    0,0,
-                                    pEngine->getWindowWidth(),pEngine->getWindowHeight(),
-                                    i*4, 0);
-            m_backgroundWaves.push_back(back);
-        }
-        backSource.reset();
+        //Just a strip of wave tiles, shifted along as they animate
+        m_waves.reset();
+        m_waves = make_shared<WaveBackground>(pEngine, "./resources/TileMaps/WavesTiles.txt");
     }
 
     
@@ -197,13 +164,11 @@ private:
 protected:
     shared_ptr<MapOffsetFilter> m_mapFilter = nullptr;
     shared_ptr<MapTileManager> m_collisionMap = nullptr;
-    shared_ptr<DrawingSurface> m_srcSurface = nullptr;
-    shared_ptr<DrawingSurface> m_effectsSurface = nullptr; //For blood effects
+    shared_ptr<MapTileManager> m_grassMap = nullptr; //Only drawn, no collision
+    shared_ptr<MapTileManager> m_floorMap = nullptr;
+    shared_ptr<WorldSurface> m_world = nullptr;
     shared_ptr<DrawingSurface> m_hudSurface = nullptr; //Needs to be drawn on last
-    shared_ptr<DrawingSurface> m_waveSurface = nullptr; //Needs to be drawn on last
-    vector<shared_ptr<DrawingSurface>> m_backgroundWaves;
-    int m_wavesCounter = 0;
-    int m_wavesLastUpdated = 0;
+    shared_ptr<WaveBackground> m_waves = nullptr; //Drawn first, under the map
 };
 
 #endif //G52CPP_SURFACEMANAGER_H
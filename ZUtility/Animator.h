@@ -8,6 +8,8 @@
 
 #include "../../header.h"
 #include "../ZPixels/ImagePixelRepo.h"
+#include "Random.h"
+#include "../ZMaps/WorldSurface.h"
 
 using namespace std;
 
@@ -39,25 +41,29 @@ public:
     }
 
 
-    //Paints a random blood splatter in the given location on the effects surface
+    //Paints a random blood splatter in the given location straight onto the map (world surface)
+    //The world surface keeps it, so it's painted again whenever a page or tile under it is redrawn
     static void paintBlood(ZEngine *pEngine, int xVal, int yVal){
-        //Get the blood image from our repo
-        shared_ptr<vector<shared_ptr<SimpleImage>>> bloodImages = ImagePixelRepo::getMultiImages()->at("Blood");
-        int randomImage = rand() % bloodImages->size();
-        shared_ptr<SimpleImage> blood = (*bloodImages)[randomImage];
+        shared_ptr<SimpleImage> blood = bloodImage(xVal, yVal);
 
         xVal = xVal - blood->getWidth()/2;
         yVal = yVal - blood->getHeight()/2;
 
-        //DrawingSurface* surface = pEngine->getSrcSurface();
-        DrawingSurface* surface = pEngine->getEffectsSurface();
-        surface->mySDLLockSurface();
-        blood->renderImageWithMaskAndTransparency(surface,
-                                                  0,0,
-                                                  xVal,yVal,
-                                                  blood->getWidth(),blood->getHeight(),
-                                                  blood->getPixelColour(0,0),100);
-        surface->mySDLUnlockSurface();
+        pEngine->getWorldSurface()->stamp(blood, xVal, yVal);
+        //Needs copying onto the screen (if it's on it)
+        MapOffsetFilter* mapFilter = pEngine->getMapFilter().get();
+        pEngine->getDirtyRegions().changed(mapFilter->filterConvertRealToVirtualXPosition(xVal),
+                                           mapFilter->filterConvertRealToVirtualYPosition(yVal),
+                                           blood->getWidth(), blood->getHeight());
+    }
+
+private:
+    //Picked by location, so the same blood looks the same after loading
+    static shared_ptr<SimpleImage> bloodImage(int xVal, int yVal){
+        shared_ptr<vector<shared_ptr<SimpleImage>>> bloodImages = ImagePixelRepo::getMultiImages()->at("Blood");
+        int randomImage = Random::forKey(Random::r_blood, Random::key(xVal, yVal))
+                .nextInt(static_cast<int>(bloodImages->size()));
+        return (*bloodImages)[randomImage];
     }
 
 };
@@ -0,0 +1,108 @@
+//
+// Created by Chris Greer on 16/05/2024.
+//
+
+#ifndef G52CPP_DIRTYREGIONS_H
+#define G52CPP_DIRTYREGIONS_H
+
+#include "../../header.h"
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+//Keeps track of which parts of the screen need the background copying back onto them each frame,
+//so a frame where not much has moved only copies those parts rather than the whole window
+//Two kinds of area (both screen locations):
+//  changed - the background itself is different there (blood painted, tile redrawn), needs copying this frame
+//  drawnOver - something was drawn on top (a sprite, the laser), needs the background back next frame
+//If there's too much to copy (or the whole thing has changed, e.g. the map scrolled) it just does the whole screen
+class DirtyRegions {
+
+public:
+    struct Rect {
+        int left, top, right, bottom; //Right and bottom aren't included
+        int width() const { return right - left; }
+        int height() const { return bottom - top; }
+        bool overlaps(const Rect& other) const {
+            return left < other.right && other.left < right && top < other.bottom && other.top < bottom;
+        }
+    };
+
+    void resize(int width, int height){
+        m_width = width;
+        m_height = height;
+        invalidateAll();
+    }
+
+    //Everything has to be copied on the next frame
+    void invalidateAll(){ m_all = true; }
+
+    void changed(int x, int y, int width, int height){ add(m_changed, x, y, width, height); }
+    void drawnOver(int x, int y, int width, int height){ add(m_drawn, x, y, width, height); }
+
+    //Called once per frame before copying the background, works out what to copy this frame
+    //Returns true if it's the whole screen (regions then just holds that)
+    bool beginFrame(vector<Rect>& regions){
+        regions.clear();
+        //Whatever was drawn last frame needs covering up again
+        regions.insert(regions.end(), m_changed.begin(), m_changed.end());
+        regions.insert(regions.end(), m_drawn.begin(), m_drawn.end());
+        m_changed.clear();
+        m_drawn.clear();
+
+        if (!m_all) merge(regions);
+        long long area = 0;
+        for (const Rect& region : regions) area += static_cast<long long>(region.width()) * region.height();
+        //Lots of small copies ends up slower than one big one
+        if (m_all || area * 2 > static_cast<long long>(m_width) * m_height) {
+            m_all = false;
+            regions.assign(1, {0, 0, m_width, m_height});
+            m_copied = regions;
+            return true;
+        }
+        m_copied = regions;
+        return false;
+    }
+
+    //Whether anything copied or drawn so far this frame touches this area (e.g. so the HUD knows to redraw)
+    bool touchedThisFrame(const Rect& area) const {
+        auto touches = [&area](const Rect& region){ return region.overlaps(area); };
+        return any_of(m_copied.begin(), m_copied.end(), touches) || any_of(m_drawn.begin(), m_drawn.end(), touches);
+    }
+
+private:
+    void add(vector<Rect>& rects, int x, int y, int width, int height){
+        Rect rect{max(x, 0), max(y, 0), min(x + width, m_width), min(y + height, m_height)};
+        if (rect.left < rect.right && rect.top < rect.bottom) rects.push_back(rect);
+    }
+
+    //Joins up any that overlap (there's only ever a few dozen, sprites near each other overlap a lot)
+    static void merge(vector<Rect>& rects){
+        bool joined = true;
+        while (joined) {
+            joined = false;
+            for (size_t i = 0; i < rects.size(); ++i) {
+                for (size_t j = i + 1; j < rects.size(); ++j) {
+                    if (!rects[i].overlaps(rects[j])) continue;
+                    rects[i] = {min(rects[i].left, rects[j].left), min(rects[i].top, rects[j].top),
+                                max(rects[i].right, rects[j].right), max(rects[i].bottom, rects[j].bottom)};
+                    rects[j] = rects.back();
+                    rects.pop_back();
+                    joined = true;
+                    j = i; //Bigger now so check the rest again
+                }
+            }
+        }
+    }
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    bool m_all = true;
+    vector<Rect> m_changed; //This frame
+    vector<Rect> m_drawn; //Last frame until beginFrame, then this frame
+    vector<Rect> m_copied; //What beginFrame said to copy this frame
+};
+
+#endif //G52CPP_DIRTYREGIONS_H
@@ -31,6 +31,12 @@ struct ObjectInfo {
     }
 };
 
+//Where the player's laser pointer goes from and to (screen locations), worked out when updating
+struct LaserLine {
+    float fromX = 0, fromY = 0, toX = 0, toY = 0;
+    bool shown = false;
+};
+
 //Structure to contain which tiles are keys and which tiles they then unlock
 struct KeyTile{
     int x = 0;
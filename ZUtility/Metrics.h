@@ -0,0 +1,133 @@
+//
+// Created by Chris Greer on 13/05/2024.
+//
+
+#ifndef G52CPP_METRICS_H
+#define G52CPP_METRICS_H
+
+#include "../../header.h"
+#include "../../DrawingSurface.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+using namespace std;
+
+//Simple profiling that can be left on while playing
+//Times how long is spent in each of the expensive parts of a frame (and how many times they're called),
+//shows the last frame's numbers on screen (F3) and writes every frame to a CSV file when the game exits
+//Define G52CPP_NO_METRICS to compile all of it out
+class Metrics {
+
+public:
+    //Each part of the frame that's timed
+    enum Section {t_solvePath, t_playerLos, t_losToPlayer, t_tileCollision, t_objectCollision,
+                  t_backgroundCopy, t_postDraw, t_count};
+
+#ifdef G52CPP_NO_METRICS
+    static constexpr bool m_enabled = false;
+#else
+    static constexpr bool m_enabled = true;
+#endif
+
+    //Times from when it's created until it goes out of scope (use METRICS_TIME rather than this directly)
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Section section) : m_section(section), m_start(chrono::steady_clock::now()) {}
+        ~ScopedTimer() { record(m_section, chrono::steady_clock::now() - m_start); }
+    private:
+        Section m_section;
+        chrono::steady_clock::time_point m_start;
+    };
+
+    //Can be called from any thread (paths are solved on the worker threads too)
+    static void record(Section section, chrono::steady_clock::duration time){
+        if (!m_enabled) return;
+        m_currentCalls[section].fetch_add(1, memory_order_relaxed);
+        m_currentNanos[section].fetch_add(chrono::duration_cast<chrono::nanoseconds>(time).count(),
+                                          memory_order_relaxed);
+    }
+
+    //Called once at the start of each main loop, everything since the last call counts as the last frame
+    static void endFrame(){
+        if (!m_enabled) return;
+        auto now = chrono::steady_clock::now();
+        if (m_frameStarted) m_lastFrameNanos = chrono::duration_cast<chrono::nanoseconds>(now - m_frameStart).count();
+        m_frameStart = now;
+        for (int i = 0; i < t_count; ++i) {
+            m_lastCalls[i] = m_currentCalls[i].exchange(0, memory_order_relaxed);
+            m_lastNanos[i] = m_currentNanos[i].exchange(0, memory_order_relaxed);
+        }
+        if (m_frameStarted) writeRow();
+        m_frameStarted = true;
+    }
+
+    static void toggleOverlay(){ m_showOverlay = !m_showOverlay; }
+
+    //Area (from the top left) the overlay covers
+    static constexpr int m_overlayWidth = 370;
+    static constexpr int m_overlayHeight = 40 + 22 * (t_count + 1);
+
+    //Last frame's numbers in the top left corner (if turned on), returns whether it was drawn
+    static bool drawOverlay(DrawingSurface* surface, Font* font){
+        if (!m_enabled || !m_showOverlay) return false;
+        surface->drawRectangle(5, 5, m_overlayWidth - 5, m_overlayHeight - 5, 0x1A1A1A);
+        char line[80];
+        snprintf(line, sizeof(line), "frame %.2f ms", m_lastFrameNanos / 1e6);
+        surface->drawFastString(10, 10, line, 0xFFFFFF, font);
+        for (int i = 0; i < t_count; ++i) {
+            snprintf(line, sizeof(line), "%-16s %5llu  %.3f ms", m_names[i],
+                     static_cast<unsigned long long>(m_lastCalls[i]), m_lastNanos[i] / 1e6);
+            surface->drawFastString(10, 32 + 22 * i, line, 0xFFFFFF, font);
+        }
+        return true;
+    }
+
+    //Finish off the CSV file (called when the game exits)
+    static void close(){
+        if (m_csv.is_open()) m_csv.close();
+    }
+
+private:
+    //One row per frame, frame time then the calls and time (ms) of each section
+    static void writeRow(){
+        if (!m_csv.is_open()) {
+            m_csv.open(m_csvPath);
+            if (!m_csv) return;
+            m_csv << "frame_ms";
+            for (const char* name : m_names) m_csv << "," << name << "_calls," << name << "_ms";
+            m_csv << "\n";
+        }
+        m_csv << m_lastFrameNanos / 1e6;
+        for (int i = 0; i < t_count; ++i) m_csv << "," << m_lastCalls[i] << "," << m_lastNanos[i] / 1e6;
+        m_csv << "\n";
+    }
+
+private:
+    inline static const char* m_names[t_count] = {"solvePath", "playerLos", "losToPlayer", "tileCollision",
+                                                  "objectCollision", "backgroundCopy", "postDraw"};
+    inline static const string m_csvPath = "./metrics.csv";
+    //This frame so far (static so start at 0)
+    inline static atomic<uint64_t> m_currentCalls[t_count];
+    inline static atomic<uint64_t> m_currentNanos[t_count];
+    inline static uint64_t m_lastCalls[t_count] = {};
+    inline static uint64_t m_lastNanos[t_count] = {};
+    inline static uint64_t m_lastFrameNanos = 0;
+    inline static chrono::steady_clock::time_point m_frameStart;
+    inline static bool m_frameStarted = false;
+    inline static bool m_showOverlay = false;
+    inline static ofstream m_csv;
+};
+
+//Times the rest of the enclosing scope as this section, e.g. METRICS_TIME(t_solvePath);
+#ifdef G52CPP_NO_METRICS
+#define METRICS_TIME(section)
+#else
+#define METRICS_CONCAT_INNER(first, second) first##second
+#define METRICS_CONCAT(first, second) METRICS_CONCAT_INNER(first, second)
+#define METRICS_TIME(section) Metrics::ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(Metrics::section)
+#endif
+
+#endif //G52CPP_METRICS_H
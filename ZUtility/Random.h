@@ -0,0 +1,137 @@
+//
+// Created by Chris Greer on 15/05/2024.
+//
+
+#ifndef G52CPP_RANDOM_H
+#define G52CPP_RANDOM_H
+
+#include "../../header.h"
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+using namespace std;
+
+//Fast random number generator (xoshiro256**), each one has its own state so nothing is shared between them
+//Same seed always gives the same numbers
+class RandomStream {
+
+public:
+    explicit RandomStream(uint64_t seed = 0){ reseed(seed); }
+
+    void reseed(uint64_t seed){
+        //Spread the seed over the whole state (an all zero state would only ever give 0)
+        for (uint64_t& word : m_state) word = splitMix(seed);
+    }
+
+    uint64_t next(){
+        uint64_t result = rotateLeft(m_state[1] * 5, 7) * 9;
+        uint64_t shifted = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= shifted;
+        m_state[3] = rotateLeft(m_state[3], 45);
+        return result;
+    }
+
+    //0 to bound - 1 (scaled rather than % so every value is as likely)
+    int nextInt(int bound){
+        if (bound <= 0) return 0;
+        return static_cast<int>(((next() >> 32) * static_cast<uint64_t>(bound)) >> 32);
+    }
+
+    //0 (included) to 1 (not included)
+    double nextDouble(){ return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    //Mixes any number into a well spread one (also used for making seeds out of keys)
+    static uint64_t splitMix(uint64_t& value){
+        uint64_t mixed = (value += 0x9E3779B97F4A7C15ULL);
+        mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+        return mixed ^ (mixed >> 31);
+    }
+
+    //State as text, for saving/loading
+    inline friend ostream& operator<<(ostream& out, const RandomStream& stream) {
+        return out << stream.m_state[0] << ' ' << stream.m_state[1] << ' ' << stream.m_state[2] << ' ' << stream.m_state[3];
+    }
+    inline friend istream& operator>>(istream& in, RandomStream& stream) {
+        return in >> stream.m_state[0] >> stream.m_state[1] >> stream.m_state[2] >> stream.m_state[3];
+    }
+
+private:
+    static uint64_t rotateLeft(uint64_t value, int bits){ return (value << bits) | (value >> (64 - bits)); }
+
+    uint64_t m_state[4];
+};
+
+//All the game's random numbers, split up by what they're for so one part using more or less
+//doesn't change what any other part gets. Everything is seeded from the level (and a base seed),
+//so the same level always plays out the same way given the same input
+//Shared streams are only used from the main thread, anything that needs its own (a tile, an object)
+//uses forKey which makes a new stream from the key, so it doesn't matter what order (or thread) they're made in
+class Random {
+
+public:
+    enum Stream {r_tileDetail, r_blood, r_spawn, r_drops, r_pickups, r_count};
+
+    //Changes every level's seed (e.g. for different headless runs), 0 by default
+    static void setBaseSeed(uint64_t seed){ m_baseSeed = seed; }
+
+    //Called when a new level is started (not when loading, the save has the streams in it)
+    static void seedLevel(const string& levelNumber){
+        //Level name hashed (FNV-1a) then mixed with the base seed
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (char letter : levelNumber) {
+            hash ^= static_cast<unsigned char>(letter);
+            hash *= 0x100000001B3ULL;
+        }
+        uint64_t seed = hash ^ m_baseSeed;
+        m_levelSeed = RandomStream::splitMix(seed);
+        for (int i = 0; i < r_count; ++i) m_streams[i].reseed(m_levelSeed + i);
+    }
+
+    //Shared stream for this part of the game (main thread only)
+    static RandomStream& stream(Stream stream){ return m_streams[stream]; }
+
+    //A stream of its own for one thing, the same key always gives the same numbers in this level
+    static RandomStream forKey(Stream stream, uint64_t key){
+        uint64_t seed = m_levelSeed ^ (static_cast<uint64_t>(stream) << 56);
+        uint64_t mixed = RandomStream::splitMix(seed) ^ key;
+        return RandomStream(RandomStream::splitMix(mixed));
+    }
+    //Key for something at a location (e.g. a tile, or where an object started)
+    static uint64_t key(int x, int y, int extra = 0){
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 40) ^
+               (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 16) ^ static_cast<uint32_t>(extra);
+    }
+
+    //Saved as a single line starting with R, the level seed then the state of each stream
+    static void save(ostream& out){
+        out << 'R' << ' ' << m_levelSeed;
+        for (const RandomStream& stream : m_streams) out << ' ' << stream;
+    }
+    static bool load(const string& line){
+        istringstream in(line);
+        char type;
+        uint64_t levelSeed;
+        RandomStream streams[r_count];
+        if (!(in >> type >> levelSeed) || type != 'R') return false;
+        for (RandomStream& stream : streams) {
+            if (!(in >> stream)) return false;
+        }
+        m_levelSeed = levelSeed;
+        for (int i = 0; i < r_count; ++i) m_streams[i] = streams[i];
+        return true;
+    }
+
+private:
+    inline static uint64_t m_baseSeed = 0;
+    inline static uint64_t m_levelSeed = 0;
+    inline static RandomStream m_streams[r_count];
+};
+
+#endif //G52CPP_RANDOM_H
@@ -10,6 +10,7 @@
 #include "../ZObjects/LivingObject.h"
 #include <filesystem>
 #include "../ZUtility/InfoStructs.h"
+#include "../ZUtility/Random.h"
 
 using namespace std;
 namespace fs = filesystem;
@@ -42,6 +43,9 @@ public:
         mapDoc << saveName << endl;
         //Then write the Level Number below that
         mapDoc << pEngine->getLevelNumber() << endl;
+        //Then where the random numbers are up to, so loading carries on exactly the same
+        Random::save(mapDoc);
+        mapDoc << endl;
 
         //Then write our tiles
         for (const auto& tiles : keyTiles) mapDoc << tiles << endl;
@@ -82,6 +86,9 @@ public:
         if(getline(mapDoc, line))
             pEngine->setLevelNumber(line);
         else return false;
+        //Random number state (older saves don't have it, just start the level's numbers again)
+        bool loadedRandom = mapDoc.peek() == 'R' && getline(mapDoc, line) && Random::load(line);
+        if (!loadedRandom) Random::seedLevel(pEngine->getLevelNumber());
 
         int k = 0;
         //Scan the Main Unlocking Tiles
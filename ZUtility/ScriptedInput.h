@@ -0,0 +1,146 @@
+//
+// Created by Chris Greer on 14/05/2024.
+//
+
+#ifndef G52CPP_SCRIPTEDINPUT_H
+#define G52CPP_SCRIPTEDINPUT_H
+
+#include "../../header.h"
+#include "../ZEngine.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+
+using namespace std;
+
+//Keyboard/mouse input read from a file rather than the window, used when running headless
+//One event per line, the frame it happens on then what it is, e.g.
+//  0 mouse 900 400
+//  10 keydown w
+//  60 mousedown left
+//  500 quit
+//Keys can be a name (w, shift, space, escape...) or the key code, lines starting with # are ignored
+class ScriptedInput {
+
+public:
+    //False if the file can't be opened or has a line that doesn't make sense
+    bool load(const string& path){
+        m_events.clear();
+        m_next = 0;
+        ifstream script(path);
+        if (!script) {
+            cerr << "Can't open input script " << path << endl;
+            return false;
+        }
+        string line;
+        int lineNumber = 0;
+        while (getline(script, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            Event event;
+            if (!parse(line, event)) {
+                cerr << path << ":" << lineNumber << " can't read \"" << line << "\"" << endl;
+                return false;
+            }
+            m_events.push_back(event);
+        }
+        //Keep the order they were written in for events on the same frame
+        stable_sort(m_events.begin(), m_events.end(),
+                    [](const Event& first, const Event& second){ return first.frame < second.frame; });
+        return true;
+    }
+
+    //Sends everything for this frame to the engine (as if it came from the window)
+    //Returns false once a quit has been reached
+    bool apply(ZEngine* pEngine, int frame){
+        while (m_next < m_events.size() && m_events[m_next].frame <= frame) {
+            const Event& event = m_events[m_next++];
+            switch (event.type) {
+                case e_keyDown:
+                    pEngine->virtKeyDown(event.first);
+                    break;
+                case e_keyUp:
+                    pEngine->virtKeyUp(event.first);
+                    break;
+                case e_mouseDown:
+                    pEngine->virtMouseDown(event.first, m_mouseX, m_mouseY);
+                    break;
+                case e_mouseUp:
+                    pEngine->virtMouseUp(event.first, m_mouseX, m_mouseY);
+                    break;
+                case e_mouse:
+                    m_mouseX = event.first;
+                    m_mouseY = event.second;
+                    break;
+                case e_quit:
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    int getMouseX() const { return m_mouseX; }
+    int getMouseY() const { return m_mouseY; }
+
+private:
+    enum EventType {e_keyDown, e_keyUp, e_mouseDown, e_mouseUp, e_mouse, e_quit};
+    struct Event {
+        int frame;
+        EventType type;
+        int first; //Key/button, or mouse x
+        int second; //Mouse y
+    };
+
+    static bool parse(const string& line, Event& event){
+        istringstream words(line);
+        string command;
+        if (!(words >> event.frame >> command)) return false;
+        event.first = 0;
+        event.second = 0;
+        string argument;
+        if (command == "keydown" || command == "keyup") {
+            event.type = command == "keydown" ? e_keyDown : e_keyUp;
+            return words >> argument && keyCode(argument, event.first);
+        }
+        if (command == "mousedown" || command == "mouseup") {
+            event.type = command == "mousedown" ? e_mouseDown : e_mouseUp;
+            if (!(words >> argument)) return false;
+            event.first = argument == "left" ? SDL_BUTTON_LEFT : atoi(argument.c_str());
+            return event.first != 0;
+        }
+        if (command == "mouse") {
+            event.type = e_mouse;
+            return static_cast<bool>(words >> event.first >> event.second);
+        }
+        if (command == "quit") {
+            event.type = e_quit;
+            return true;
+        }
+        return false;
+    }
+
+    //Named keys, a single character is its own key and anything else has to be the code itself
+    static bool keyCode(const string& name, int& code){
+        if (name == "shift") code = SDLK_LSHIFT;
+        else if (name == "space") code = SDLK_SPACE;
+        else if (name == "escape") code = SDLK_ESCAPE;
+        else if (name == "return") code = SDLK_RETURN;
+        else if (name == "backspace") code = SDLK_BACKSPACE;
+        else if (name.size() == 1) code = tolower(name[0]);
+        else if (all_of(name.begin(), name.end(), [](char c){ return isdigit(c); })) code = atoi(name.c_str());
+        else return false;
+        return true;
+    }
+
+private:
+    vector<Event> m_events; //In frame order
+    size_t m_next = 0; //First event not sent yet
+    int m_mouseX = 0;
+    int m_mouseY = 0;
+};
+
+#endif //G52CPP_SCRIPTEDINPUT_H
@@ -0,0 +1,154 @@
+//
+// Created by Chris Greer on 08/05/2024.
+//
+
+#ifndef G52CPP_SPATIALGRID_H
+#define G52CPP_SPATIALGRID_H
+
+#include "../../header.h"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+using namespace std;
+
+//Uniform grid over the map that remembers which objects are in each cell, by the box they're drawn over
+//Each object is in every cell its box touches, so finding what's at a point (the laser) or what could be
+//touching a box (melee) only means looking at a few cells rather than going through every object in the engine
+//Objects have to tell the grid when they move (update) and when they go away (remove),
+//it only moves them between cells when their box covers different cells
+template<typename T>
+class SpatialGrid {
+
+public:
+    struct Box {
+        int left, top, right, bottom; //Right and bottom aren't included
+        bool overlaps(const Box& other) const {
+            return left < other.right && other.left < right && top < other.bottom && other.top < bottom;
+        }
+    };
+
+    //Size of the area covered (real map locations) and how big each cell is
+    void resize(int width, int height, int cellSize){
+        m_cellSize = cellSize;
+        m_cellsX = max(1, (width + cellSize - 1) / cellSize);
+        m_cellsY = max(1, (height + cellSize - 1) / cellSize);
+        m_cells.assign(m_cellsX * m_cellsY, {});
+        m_entries.clear();
+    }
+
+    void clear(){
+        for (auto& cell : m_cells) cell.clear();
+        m_entries.clear();
+    }
+
+    int getCellSize() const { return m_cellSize; }
+
+    //Add the object, or update its box if it's already in the grid
+    void update(T* object, const Box& box){
+        if (m_cells.empty()) return;
+        CellRange cells = cellRange(box);
+        auto found = m_entries.find(object);
+        if (found != m_entries.end()) {
+            Entry& entry = found->second;
+            entry.box = box;
+            if (entry.cells == cells) return; //Still in the same cells, nothing to move
+            forEachCell(entry.cells, [this, object](int cell){ removeFromCell(object, cell); });
+            entry.cells = cells;
+        } else {
+            m_entries[object] = {box, cells, 0};
+        }
+        forEachCell(cells, [this, object](int cell){ m_cells[cell].push_back(object); });
+    }
+
+    void remove(T* object){
+        auto found = m_entries.find(object);
+        if (found == m_entries.end()) return;
+        forEachCell(found->second.cells, [this, object](int cell){ removeFromCell(object, cell); });
+        m_entries.erase(found);
+    }
+
+    //Which cell a real location is in (anything off the grid goes in the nearest edge cell)
+    int cellIndex(int x, int y) const {
+        return clampCell(x, m_cellsX) + clampCell(y, m_cellsY) * m_cellsX;
+    }
+
+    //Everything whose box touches the cell this real location is in (anything at that point is in there)
+    void collectAt(int x, int y, vector<T*>& found) const {
+        found.clear();
+        if (m_cells.empty()) return;
+        const vector<T*>& objects = m_cells[cellIndex(x, y)];
+        found.insert(found.end(), objects.begin(), objects.end());
+    }
+
+    //Everything whose box overlaps this one (each object only once)
+    void query(const Box& box, vector<T*>& found){
+        found.clear();
+        if (m_cells.empty()) return;
+        m_queryStamp++;
+        forEachCell(cellRange(box), [&](int cell){
+            for (T* object : m_cells[cell]) {
+                Entry& entry = m_entries[object];
+                if (entry.queryStamp == m_queryStamp) continue; //Already seen it in another cell
+                entry.queryStamp = m_queryStamp;
+                if (entry.box.overlaps(box)) found.push_back(object);
+            }
+        });
+    }
+
+    //Whether the object's box overlaps this one (so they might be colliding), false if it isn't in the grid
+    bool mayOverlap(T* object, const Box& box) const {
+        auto found = m_entries.find(object);
+        return found != m_entries.end() && found->second.box.overlaps(box);
+    }
+
+private:
+    struct CellRange {
+        int firstX, firstY, lastX, lastY;
+        bool operator==(const CellRange& other) const {
+            return firstX == other.firstX && firstY == other.firstY && lastX == other.lastX && lastY == other.lastY;
+        }
+    };
+    struct Entry {
+        Box box;
+        CellRange cells;
+        unsigned int queryStamp;
+    };
+
+    //Cells a box covers (anything off the grid goes in the nearest edge cells)
+    CellRange cellRange(const Box& box) const {
+        return {clampCell(box.left, m_cellsX), clampCell(box.top, m_cellsY),
+                clampCell(box.right - 1, m_cellsX), clampCell(box.bottom - 1, m_cellsY)};
+    }
+    int clampCell(int location, int cells) const {
+        return min(max(location >= 0 ? location / m_cellSize : 0, 0), cells - 1);
+    }
+
+    template<typename Visit>
+    void forEachCell(const CellRange& cells, Visit visit){
+        for (int cellY = cells.firstY; cellY <= cells.lastY; ++cellY) {
+            for (int cellX = cells.firstX; cellX <= cells.lastX; ++cellX) {
+                visit(cellX + cellY * m_cellsX);
+            }
+        }
+    }
+
+    void removeFromCell(T* object, int cell){
+        vector<T*>& objects = m_cells[cell];
+        auto position = find(objects.begin(), objects.end(), object);
+        if (position == objects.end()) return;
+        //Order doesn't matter, swap with the last one
+        *position = objects.back();
+        objects.pop_back();
+    }
+
+private:
+    int m_cellSize = 1;
+    int m_cellsX = 0;
+    int m_cellsY = 0;
+    vector<vector<T*>> m_cells;
+    unordered_map<T*, Entry> m_entries; //Box and cells for each object
+    unsigned int m_queryStamp = 0;
+};
+
+#endif //G52CPP_SPATIALGRID_H
@@ -0,0 +1,70 @@
+//
+// Created by Chris Greer on 06/05/2024.
+//
+
+#ifndef G52CPP_TILETRAVERSAL_H
+#define G52CPP_TILETRAVERSAL_H
+
+#include "../../header.h"
+#include <cmath>
+
+//Walks through every tile a line passes over, in order, visiting each one exactly once
+//(Amanatides & Woo grid traversal) rather than sampling points along the line which can skip over corners
+//A line exactly through a corner visits both tiles next to the corner too, so it can't slip between two
+//tiles that only touch at their corners
+class TileTraversal {
+
+public:
+    //Coordinates are in tiles (i.e. real location / tile size) so can start part way through a tile
+    //visit(tileX, tileY) is called for each tile, return false from it to stop early
+    //Returns true if we got to the end tile without being stopped
+    template<typename Visit>
+    static bool traverse(float fromX, float fromY, float toX, float toY, Visit visit) {
+
+        int tileX = static_cast<int>(floor(fromX));
+        int tileY = static_cast<int>(floor(fromY));
+        int endTileX = static_cast<int>(floor(toX));
+        int endTileY = static_cast<int>(floor(toY));
+
+        float deltaX = toX - fromX;
+        float deltaY = toY - fromY;
+        int stepX = deltaX > 0 ? 1 : -1;
+        int stepY = deltaY > 0 ? 1 : -1;
+
+        //How far along the line (0 to 1) it takes to cross a whole tile in each direction
+        float tDeltaX = deltaX != 0 ? 1.0f / fabs(deltaX) : INFINITY;
+        float tDeltaY = deltaY != 0 ? 1.0f / fabs(deltaY) : INFINITY;
+        //And how far along the line until we first cross into the next column/row
+        float tMaxX = deltaX != 0 ? (deltaX > 0 ? static_cast<float>(tileX + 1) - fromX : fromX - static_cast<float>(tileX)) * tDeltaX : INFINITY;
+        float tMaxY = deltaY != 0 ? (deltaY > 0 ? static_cast<float>(tileY + 1) - fromY : fromY - static_cast<float>(tileY)) * tDeltaY : INFINITY;
+
+        //Always exactly one step per column/row crossed
+        int remaining = abs(endTileX - tileX) + abs(endTileY - tileY);
+        while (true) {
+            if (!visit(tileX, tileY)) return false;
+            if (remaining-- == 0) return true;
+
+            //Exactly through a corner, check the tiles either side of it then go diagonally
+            //(that's a column and a row crossed at once)
+            if (tileX != endTileX && tileY != endTileY && tMaxX == tMaxY) {
+                if (!visit(tileX + stepX, tileY) || !visit(tileX, tileY + stepY)) return false;
+                tMaxX += tDeltaX;
+                tileX += stepX;
+                tMaxY += tDeltaY;
+                tileY += stepY;
+                remaining--;
+                continue;
+            }
+            //Otherwise step whichever way we cross first, never past the end column/row
+            if (tileY == endTileY || (tileX != endTileX && tMaxX < tMaxY)) {
+                tMaxX += tDeltaX;
+                tileX += stepX;
+            } else {
+                tMaxY += tDeltaY;
+                tileY += stepY;
+            }
+        }
+    }
+};
+
+#endif //G52CPP_TILETRAVERSAL_H